@@ -0,0 +1,101 @@
+#pragma warning(push)
+#pragma warning(disable: 6495)   // Conditional expression is constant
+#include "gtest/gtest.h"
+#pragma warning(pop)
+#include "rapidxml.hpp"
+#include "RapidXMLSTD.hpp"
+#include <chrono>
+#include <cstdio>
+
+//builds a document the way editing code does, with names, values and attributes allocated between the nodes
+static size_t BuildDocument(rapidxml::xml_document<>& doc, size_t groups, size_t items)
+{
+	char buffer[128];
+	size_t count = 0;
+	XMLElement* root = doc.allocate_node(rapidxml::node_type::node_element, "Root");
+	doc.append_node(root);
+	for (size_t i = 0; i < groups; i++)
+	{
+		snprintf(buffer, sizeof(buffer), "Group%zu", i);
+		XMLElement* group = doc.allocate_node(rapidxml::node_type::node_element, doc.allocate_string(buffer));
+		root->append_node(group);
+		count++;
+		for (size_t j = 0; j < items; j++)
+		{
+			snprintf(buffer, sizeof(buffer), "Item%zu", j);
+			XMLElement* item = doc.allocate_node(rapidxml::node_type::node_element, doc.allocate_string(buffer));
+			snprintf(buffer, sizeof(buffer), "Some text content of item %zu in group %zu", j, i);
+			item->value(doc.allocate_string(buffer));
+			item->append_attribute(doc.allocate_attribute("id", doc.allocate_string(buffer + 5)));
+			item->append_attribute(doc.allocate_attribute("kind", doc.allocate_string(buffer + 10)));
+			group->append_node(item);
+			count++;
+		}
+	}
+	return count;
+}
+
+//visits every element using first_node / next_sibling / parent only
+static size_t Navigate(rapidxml::xml_document<>& doc)
+{
+	size_t count = 0;
+	XMLElement* root = doc.first_node();
+	for (XMLElement* node = root->first_node(); node; )
+	{
+		count++;
+		if (node->first_node())
+			node = node->first_node();
+		else
+		{
+			while (node != root && !node->next_sibling())
+				node = node->parent();
+			node = node == root ? nullptr : node->next_sibling();
+		}
+	}
+	return count;
+}
+
+//returns best time of several runs, in microseconds
+static double TimeNavigation(rapidxml::xml_document<>& doc, size_t expected)
+{
+	double best = 0;
+	for (int run = 0; run < 10; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		size_t count = Navigate(doc);
+		auto end = std::chrono::steady_clock::now();
+		EXPECT_EQ(count, expected);
+		double elapsed = std::chrono::duration<double, std::micro>(end - start).count();
+		if (run == 0 || elapsed < best)
+			best = elapsed;
+	}
+	return best;
+}
+
+//measures pure navigation with and without segregated arenas; timings are only printed, so it is disabled by default,
+//run it with --gtest_also_run_disabled_tests --gtest_filter=BenchmarkTests.*
+TEST(BenchmarkTests, DISABLED_SegregatedArenasNavigation)
+{
+	const size_t groups = 200;
+	const size_t items = 500;
+
+	rapidxml::xml_document<> interleaved;
+	size_t expected = BuildDocument(interleaved, groups, items);
+
+	rapidxml::xml_document<> segregated;
+	segregated.set_segregated_arenas(true);
+	EXPECT_EQ(BuildDocument(segregated, groups, items), expected);
+
+	//compaction keeps arena layout of the pool
+	rapidxml::xml_document<> compacted;
+	compacted.set_segregated_arenas(true);
+	BuildDocument(compacted, groups, items);
+	compacted.compact();
+
+	double interleavedTime = TimeNavigation(interleaved, expected);
+	double segregatedTime = TimeNavigation(segregated, expected);
+	double compactedTime = TimeNavigation(compacted, expected);
+
+	printf("Navigation of %zu elements: interleaved %.0f us, segregated %.0f us, segregated and compacted %.0f us\n",
+		expected, interleavedTime, segregatedTime, compactedTime);
+}
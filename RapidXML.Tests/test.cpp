@@ -4,7 +4,24 @@
 #pragma warning(pop)
 #include "rapidxml.hpp"
 #include "rapidxml_utils.hpp"
+#include "rapidxml_pages.hpp"
+#include "rapidxml_vocabulary.hpp"
+#include "rapidxml_index.hpp"
+#include "rapidxml_query.hpp"
+#include "rapidxml_iterators.hpp"
+#include "rapidxml_ranges.hpp"
+#include "rapidxml_parallel.hpp"
+#include "rapidxml_concurrent.hpp"
 #include "RapidXMLSTD.hpp"
+#include "rapidxml_print.hpp"
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 TEST(BasicTests, BasicReadXML) 
 {
@@ -134,4 +151,1497 @@ TEST(BasicTests, BasicWriteXML)
 		}();
 
 	::DisposeXMLObject(doc);
-}
\ No newline at end of file
+}
+
+TEST(MemoryTests, MemoryResource)
+{
+	//counts bytes requested by the pool
+	struct counting_resource : std::pmr::memory_resource
+	{
+		size_t allocated = 0;
+		size_t deallocated = 0;
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			allocated += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override
+		{
+			deallocated += bytes;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	} resource;
+
+	{
+		rapidxml::xml_document<> doc(&resource);
+		EXPECT_EQ(doc.memory_resource(), &resource);
+
+		//document has no static memory, so dynamic blocks are requested
+		for (size_t i = 0; i < 4096; i++)
+			doc.append_node(doc.allocate_node(rapidxml::node_type::node_element, "Node"));
+
+		EXPECT_GT(resource.allocated, 0u);
+		EXPECT_EQ(resource.deallocated, 0u);
+	}
+
+	EXPECT_EQ(resource.allocated, resource.deallocated);
+}
+
+TEST(MemoryTests, PageResource)
+{
+	rapidxml::page_resource pages(rapidxml::pages_transparent_huge | rapidxml::pages_prefault);
+	EXPECT_EQ(pages.granularity(rapidxml::page_resource::huge_page_size), rapidxml::page_resource::huge_page_size);
+
+	//pool blocks smaller than a huge page use regular pages
+	EXPECT_LT(pages.granularity(RAPIDXML_DYNAMIC_POOL_SIZE), rapidxml::page_resource::huge_page_size);
+	EXPECT_EQ(rapidxml::page_resource(0).granularity(rapidxml::page_resource::huge_page_size), rapidxml::page_resource(0).granularity(1));
+
+	rapidxml::xml_document<> doc(&pages);
+	for (size_t i = 0; i < 4096; i++)
+		doc.append_node(doc.allocate_node(rapidxml::node_type::node_element, "Node"));
+
+	//oversized single allocation is backed by its own mapping
+	char* big = doc.allocate_string(0, 3 * rapidxml::page_resource::huge_page_size);
+	big[0] = 'a';
+	big[3 * rapidxml::page_resource::huge_page_size - 1] = 'z';
+
+	size_t count = 0;
+	for (XMLElement* x = doc.first_node(); x; x = x->next_sibling())
+		count++;
+	EXPECT_EQ(count, 4096u);
+
+	doc.clear();
+	EXPECT_FALSE(doc.first_node());
+}
+
+TEST(MemoryTests, StaticMemory)
+{
+	//documents embed static memory by default, and allocate nodes from it
+	auto embedded = std::make_unique<rapidxml::xml_document<>>();
+	EXPECT_GT(sizeof(*embedded), size_t(RAPIDXML_STATIC_POOL_SIZE));
+	EXPECT_EQ(embedded->static_memory_size(), size_t(RAPIDXML_STATIC_POOL_SIZE));
+	XMLElement* root = embedded->allocate_node(rapidxml::node_type::node_element, "Root");
+	embedded->append_node(root);
+	EXPECT_GE((char*)root, (char*)embedded.get());
+	EXPECT_LT((char*)root, (char*)embedded.get() + sizeof(*embedded));
+
+	//caller-supplied buffer
+	char buffer[2048];
+	char text[] = "<Message Id=\"1\"><Body>Hello</Body></Message>";
+	rapidxml::xml_document<> small(buffer, sizeof(buffer));
+	small.parse<0>(text);
+	EXPECT_EQ(small.static_memory_size(), sizeof(buffer));
+	XMLElement* body = small.first_node("Message")->first_node("Body");
+	EXPECT_GE((char*)body, buffer);
+	EXPECT_LT((char*)body, buffer + sizeof(buffer));
+
+	//no static memory at all
+	rapidxml::xml_document<> dynamic(nullptr, 0);
+	EXPECT_EQ(dynamic.static_memory_size(), 0u);
+	dynamic.append_node(dynamic.allocate_node(rapidxml::node_type::node_element, "Root"));
+	EXPECT_STREQ(dynamic.first_node()->name(), "Root");
+
+	//documents embedding no static memory are small, and documents embedding some are documents too
+	static_assert(sizeof(rapidxml::xml_document<char, 0>) < 512, "document without static memory should be small");
+	static_assert(sizeof(rapidxml::xml_document<char, 1024>) < 1024 + 512, "document should embed requested amount of static memory");
+#if !defined(RAPIDXML_NODE_COUNTS) && !defined(RAPIDXML_DOCUMENT_ORDER) && !defined(RAPIDXML_ATTRIBUTE_ARRAYS) && !defined(RAPIDXML_CHILD_INDEX) && !defined(RAPIDXML_NAME_HASHES) && !defined(RAPIDXML_NAME_SYMBOLS)
+	static_assert(sizeof(XMLElement) == 12 * sizeof(void*), "optional node data should not make nodes larger by default");
+	static_assert(sizeof(XMLAttributte) == 7 * sizeof(void*), "optional name data should not make attributes larger by default");
+#endif
+	rapidxml::xml_document<char, 0> tiny;
+	EXPECT_EQ(tiny.static_memory_size(), 0u);
+	char tiny_text[] = "<Tiny/>";
+	tiny.parse<0>(tiny_text);
+	EXPECT_EQ(tiny.first_node()->document(), &tiny);
+	rapidxml::xml_document<char, 1024> sized;
+	EXPECT_EQ(sized.static_memory_size(), 1024u);
+	sized.append_node(sized.allocate_node(rapidxml::node_type::node_element, "Root"));
+	EXPECT_EQ(sized.first_node()->document(), &sized);
+	EXPECT_GE((char*)sized.first_node(), (char*)&sized);
+	EXPECT_LT((char*)sized.first_node(), (char*)&sized + sizeof(sized));
+}
+
+TEST(MemoryTests, FreeListRecycling)
+{
+	std::string error;
+	XMLDocument* doc = ::CreateXML(1, "utf-8", error);
+	ASSERT_TRUE(doc) << error;
+	XMLElement* root = ::CreateElement(doc, "Root", "", error);
+	::AddElementToDocument(doc, root, error);
+
+	//a subtree with nested children and attributes
+	XMLElement* child = ::CreateElement(doc, "Child", "", error);
+	XMLElement* grandchild = ::CreateElement(doc, "GrandChild", "", error);
+	::AddElementToElement(child, grandchild, error);
+	::AddAttributeToElement(child, ::CreateAttribute(doc, "ID", "1", error), error);
+	::AddElementToElement(root, child, error);
+
+	EXPECT_TRUE(::RemoveElementFromElement(root, child, error)) << error;
+	EXPECT_FALSE(root->first_node());
+
+	//freed nodes and attributes are handed out again, most recently freed first
+	XMLElement* reused1 = doc->allocate_node(rapidxml::node_type::node_element);
+	XMLElement* reused2 = doc->allocate_node(rapidxml::node_type::node_element);
+	EXPECT_TRUE((reused1 == child && reused2 == grandchild) || (reused1 == grandchild && reused2 == child));
+	EXPECT_FALSE(reused1->first_node());
+	EXPECT_FALSE(reused1->first_attribute());
+
+	//steady-state editing does not consume new memory
+	XMLAttributte* attribute = doc->allocate_attribute("A", "B");
+	root->append_attribute(attribute);
+	for (size_t i = 0; i < 10000; i++)
+	{
+		EXPECT_TRUE(::RemoveAttributeFromElement(root, attribute, error)) << error;
+		XMLAttributte* next = doc->allocate_attribute("A", "B");
+		EXPECT_EQ(next, attribute);
+		root->append_attribute(next);
+	}
+
+	//repeatedly setting values of varying length reuses the previous value's memory
+	std::set<const char*> values;
+	for (size_t i = 0; i < 10000; i++)
+	{
+		EXPECT_TRUE(::SetElementValueA(root, std::string(i % 40, 'x'), error)) << error;
+		values.insert(root->value());
+	}
+	EXPECT_LE(values.size(), 8u);
+	EXPECT_EQ(std::string(root->value()), std::string(9999 % 40, 'x'));
+
+	//names and values of removed elements are reused as well
+	std::set<const char*> names;
+	for (size_t i = 0; i < 10000; i++)
+	{
+		XMLElement* element = ::CreateElement(doc, "Element" + std::to_string(i % 100), std::to_string(i), error);
+		::AddElementToElement(root, element, error);
+		names.insert(element->name());
+		EXPECT_TRUE(::RemoveElementFromElement(root, element, error)) << error;
+	}
+	EXPECT_LE(names.size(), 2u);
+
+	//elements outside of a document are left in place, since there is no document to return their memory to
+	XMLElement* detached = ::CreateElement(doc, "Detached", "", error);
+	XMLElement* inner = ::CreateElement(doc, "Inner", "", error);
+	::AddElementToElement(detached, inner, error);
+	EXPECT_FALSE(::RemoveElementFromElement(detached, inner, error));
+	EXPECT_EQ(error, "Parent does not belong to a document");
+	EXPECT_EQ(detached->first_node(), inner);
+
+	::DisposeXMLObject(doc);
+}
+
+TEST(MemoryTests, Compact)
+{
+	//tracks bytes currently held by the pool
+	struct tracking_resource : std::pmr::memory_resource
+	{
+		size_t in_use = 0;
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			in_use += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void* p, size_t bytes, size_t alignment) override
+		{
+			in_use -= bytes;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	} resource;
+
+	char text[] = "<Root A=\"1\"><Keep B=\"2\">Value<Inner/></Keep><Drop/></Root>";
+	rapidxml::xml_document<> doc(&resource);
+	doc.parse<0>(text);
+
+	//heavy editing leaves dead data behind
+	XMLElement* root = doc.first_node("Root");
+	for (size_t i = 0; i < 5000; i++)
+	{
+		XMLElement* x = doc.allocate_node(rapidxml::node_type::node_element, doc.allocate_string("Temp"));
+		root->append_node(x);
+		root->remove_node(x);
+	}
+	root->remove_node(root->first_node("Drop"));
+
+	std::string before;
+	rapidxml::print(std::back_inserter(before), doc);
+	size_t used = resource.in_use;
+
+	doc.compact();
+
+	std::string after;
+	rapidxml::print(std::back_inserter(after), doc);
+	EXPECT_EQ(before, after);
+	EXPECT_LT(resource.in_use, used);
+
+	//tree no longer refers to source text
+	std::fill(std::begin(text), std::end(text) - 1, 'x');
+	EXPECT_STREQ(doc.first_node()->first_node()->first_attribute("B")->value(), "2");
+	EXPECT_STREQ(doc.first_node()->first_node()->value(), "Value");
+	EXPECT_EQ(doc.first_node()->first_node()->first_node()->parent(), doc.first_node()->first_node());
+}
+
+TEST(MemoryTests, SegregatedArenas)
+{
+	//builds elements the way editing code does, with names, values and attributes allocated between the nodes
+	auto build = [](rapidxml::xml_document<>& doc)
+	{
+		XMLElement* root = doc.allocate_node(rapidxml::node_type::node_element, "Root");
+		doc.append_node(root);
+		for (int i = 0; i < 10; i++)
+		{
+			XMLElement* item = doc.allocate_node(rapidxml::node_type::node_element, doc.allocate_string(("Item" + std::to_string(i)).c_str()));
+			item->value(doc.allocate_string(("Text of item " + std::to_string(i)).c_str()));
+			item->append_attribute(doc.allocate_attribute("id", doc.allocate_string(std::to_string(i).c_str())));
+			root->append_node(item);
+		}
+	};
+
+	//true if consecutive items are adjacent, with their attributes and strings outside of the span of the nodes
+	auto nodes_apart = [](rapidxml::xml_document<>& doc)
+	{
+		XMLElement* first = doc.first_node()->first_node();
+		char* begin = reinterpret_cast<char*>(first);
+		ptrdiff_t stride = reinterpret_cast<char*>(first->next_sibling()) - begin;
+		char* end = reinterpret_cast<char*>(doc.first_node()->last_node()) + stride;
+		bool apart = stride > 0;
+		for (XMLElement* item = first; item; item = item->next_sibling())
+		{
+			char* data[] = { reinterpret_cast<char*>(item->first_attribute()), item->name(), item->value(), item->first_attribute()->value() };
+			for (char* p : data)
+				apart = apart && (p < begin || p >= end);
+			if (item->next_sibling())
+				apart = apart && reinterpret_cast<char*>(item->next_sibling()) - reinterpret_cast<char*>(item) == stride;
+		}
+		return apart;
+	};
+
+	rapidxml::xml_document<> interleaved;
+	build(interleaved);
+	EXPECT_FALSE(interleaved.segregated_arenas());
+	EXPECT_FALSE(nodes_apart(interleaved));
+
+	rapidxml::xml_document<> segregated;
+	segregated.set_segregated_arenas(true);
+	build(segregated);
+	EXPECT_TRUE(nodes_apart(segregated));
+
+	//compaction keeps arena layout of the pool
+	std::string before;
+	rapidxml::print(std::back_inserter(before), segregated);
+	segregated.compact();
+	std::string after;
+	rapidxml::print(std::back_inserter(after), segregated);
+	EXPECT_EQ(before, after);
+	EXPECT_TRUE(segregated.segregated_arenas());
+	EXPECT_TRUE(nodes_apart(segregated));
+}
+
+TEST(MemoryTests, Relayout)
+{
+	//builds a few levels of wide elements, with attributes and text
+	rapidxml::xml_document<> source;
+	XMLElement* root = source.allocate_node(rapidxml::node_type::node_element, "Root");
+	source.append_node(root);
+	for (int i = 0; i < 50; i++)
+	{
+		XMLElement* group = source.allocate_node(rapidxml::node_type::node_element, "Group", source.allocate_string(std::to_string(i).c_str()));
+		group->append_attribute(source.allocate_attribute("id", source.allocate_string(std::to_string(i).c_str())));
+		root->append_node(group);
+		for (int j = 0; j < 20; j++)
+		{
+			XMLElement* item = source.allocate_node(rapidxml::node_type::node_element, "Item");
+			item->append_node(source.allocate_node(rapidxml::node_type::node_element, "Leaf"));
+			group->append_node(item);
+		}
+	}
+	std::string expected;
+	rapidxml::print(std::back_inserter(expected), source);
+
+	const int layouts[] = { rapidxml::layout_depth_first, rapidxml::layout_depth_first | rapidxml::layout_inline_children, rapidxml::layout_breadth_first, rapidxml::layout_blocked };
+	for (int layout : layouts)
+	{
+		rapidxml::xml_document<> doc;
+		std::string text = expected;
+		doc.parse<0>(&text[0]);
+		doc.relayout(layout);
+
+		std::string actual;
+		rapidxml::print(std::back_inserter(actual), doc);
+		EXPECT_EQ(actual, expected);
+
+		//links are intact in both directions
+		XMLElement* group = doc.first_node()->last_node();
+		EXPECT_STREQ(group->first_attribute("id")->value(), "49");
+		EXPECT_EQ(group->last_node()->previous_sibling()->next_sibling(), group->last_node());
+		EXPECT_EQ(group->last_node()->first_node()->parent()->parent(), group);
+
+		//children of a node form an array, except in plain document order
+		XMLElement* first = doc.first_node()->first_node();
+		ptrdiff_t stride = reinterpret_cast<char*>(first->next_sibling()) - reinterpret_cast<char*>(first);
+		if (layout != rapidxml::layout_depth_first)
+		{
+			EXPECT_EQ(reinterpret_cast<char*>(doc.first_node()->last_node()) - reinterpret_cast<char*>(first), stride * 49);
+		}
+
+		//blocks start at block boundaries, and children of a group only cross one if they could not fit between two
+		if (layout == rapidxml::layout_blocked)
+		{
+			const uintptr_t block = RAPIDXML_LAYOUT_BLOCK_SIZE;
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(doc.first_node()) % block, 0u);
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % block, 0u);
+			for (XMLElement* g = first; g; g = g->next_sibling())
+			{
+				uintptr_t begin = reinterpret_cast<uintptr_t>(g->first_node());
+				uintptr_t end = reinterpret_cast<uintptr_t>(g->last_node()) + stride;
+				EXPECT_TRUE(begin % block == 0 || begin / block == (end - 1) / block);
+			}
+		}
+	}
+}
+
+TEST(MemoryTests, ContiguousAttributes)
+{
+	char text[] = "<Root><A a=\"1\" b=\"2\" c=\"3\" d=\"4\"/><B/></Root>";
+	rapidxml::xml_document<> doc;
+
+	//recycled attributes come back in reverse order, so parser has to move them into an array
+	XMLAttributte* recycled[4];
+	for (int i = 0; i < 4; i++)
+		recycled[i] = doc.allocate_attribute("x", "y");
+	for (int i = 0; i < 4; i++)
+		doc.free_attribute(recycled[i]);
+
+	doc.parse<rapidxml::parse_contiguous_attributes>(text);
+
+	XMLElement* a = doc.first_node()->first_node("A");
+	EXPECT_TRUE(a->contiguous_attributes());
+	EXPECT_STREQ(a->attribute(0)->value(), "1");
+	EXPECT_STREQ(a->attribute(3)->value(), "4");
+	EXPECT_EQ(a->attribute(4), nullptr);
+	EXPECT_EQ(a->attribute(1) + 1, a->attribute(2));
+	EXPECT_EQ(a->first_attribute("c"), a->attribute(2));
+	EXPECT_EQ(a->first_attribute("e"), nullptr);
+	EXPECT_EQ(a->attribute(2)->next_attribute(), a->attribute(3));
+	EXPECT_EQ(a->last_attribute()->previous_attribute()->parent(), a);
+	EXPECT_EQ(doc.first_node()->first_node("B")->attribute(0), nullptr);
+
+	//modification falls back to links
+	a->remove_attribute(a->attribute(1));
+	EXPECT_FALSE(a->contiguous_attributes());
+	EXPECT_STREQ(a->attribute(1)->value(), "3");
+	EXPECT_EQ(a->first_attribute("b"), nullptr);
+
+	//compaction stores them as array again
+	doc.compact();
+	a = doc.first_node()->first_node("A");
+	EXPECT_TRUE(a->contiguous_attributes());
+	EXPECT_STREQ(a->attribute(2)->value(), "4");
+}
+
+TEST(BasicTests, NameHashes)
+{
+	char text[] = "<Root><Item id=\"1\" kind=\"a\"/><Other/><Item id=\"2\" kind=\"b\"/><item/></Root>";
+	rapidxml::xml_document<> doc;
+	doc.parse<rapidxml::parse_name_hashes>(text);
+
+	XMLElement* root = doc.first_node("Root");
+	ASSERT_NE(root, nullptr);
+	XMLElement* item = root->first_node("Item");
+#ifdef RAPIDXML_NAME_HASHES
+	EXPECT_NE(root->name_hash(), 0u);
+	EXPECT_EQ(item->name_hash(), root->last_node("Item")->name_hash());
+	EXPECT_NE(item->name_hash(), root->first_node("Other")->name_hash());
+#else
+	EXPECT_EQ(root->name_hash(), 0u);
+#endif
+	EXPECT_STREQ(item->next_sibling("Item")->first_attribute("id")->value(), "2");
+	EXPECT_STREQ(item->first_attribute("kind")->value(), "a");
+	EXPECT_EQ(item->first_attribute("kin", 3), nullptr);
+	EXPECT_EQ(root->first_node("item", 0, false), item);
+	EXPECT_EQ(root->last_node("ITEM", 0, false), root->last_node());
+
+	//renaming discards hash, lookups still work
+	item->name("Renamed");
+	EXPECT_EQ(item->name_hash(), 0u);
+	EXPECT_EQ(root->first_node("Renamed"), item);
+	item->hash_name();
+#ifdef RAPIDXML_NAME_HASHES
+	EXPECT_NE(item->name_hash(), 0u);
+#endif
+	EXPECT_EQ(root->first_node("Renamed"), item);
+	EXPECT_STREQ(root->first_node("Item")->first_attribute("id")->value(), "2");
+
+	//hashes survive compaction
+	doc.compact();
+#ifdef RAPIDXML_NAME_HASHES
+	EXPECT_EQ(doc.first_node()->first_node()->name_hash(), rapidxml::internal::hash("Renamed", 7));
+#endif
+
+	std::string error;
+	EXPECT_EQ(FirstOrDefaultElement(doc.first_node(), "Other", error), doc.first_node()->first_node("Other"));
+}
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+TEST(BasicTests, SymbolTable)
+{
+	rapidxml::xml_symbol_table<> symbols;
+	std::uint32_t item = symbols.intern("Item");
+
+	char first[] = "<Root><Other id=\"0\"/><Item id=\"1\"/><Item id=\"2\" kind=\"x\"/></Root>";
+	char second[] = "<Item id=\"3\"/>";
+	rapidxml::xml_document<> doc1, doc2;
+	doc1.set_symbol_table(&symbols);
+	doc2.set_symbol_table(&symbols);
+	doc1.parse<rapidxml::parse_intern_names>(first);
+	doc2.parse<rapidxml::parse_intern_names>(second);
+
+	//equal names get equal symbols across documents sharing the table
+	EXPECT_EQ(symbols.size(), 5u);
+	EXPECT_EQ(doc2.first_node()->symbol(), item);
+	EXPECT_EQ(doc1.first_node()->first_node_by_symbol(item), doc1.first_node()->first_node("Item"));
+#ifdef RAPIDXML_NAME_HASHES
+	EXPECT_NE(doc1.first_node()->name_hash(), 0u);
+#endif
+	std::uint32_t id = symbols.find("id");
+	EXPECT_EQ(doc2.first_node()->first_attribute()->symbol(), id);
+	EXPECT_EQ(symbols.find("missing"), 0u);
+	EXPECT_STREQ(symbols.name(item), "Item");
+
+	XMLElement* second_item = doc1.first_node()->first_node_by_symbol(item)->next_sibling_by_symbol(item);
+	ASSERT_NE(second_item, nullptr);
+	EXPECT_STREQ(second_item->first_attribute_by_symbol(id)->value(), "2");
+	EXPECT_STREQ(second_item->first_attribute()->next_attribute_by_symbol(symbols.find("kind"))->value(), "x");
+	EXPECT_EQ(second_item->next_sibling_by_symbol(item), nullptr);
+
+	//switching on symbols
+	int items = 0;
+	for (XMLElement* node = doc1.first_node()->first_node(); node; node = node->next_sibling())
+		if (node->symbol() == item)
+			items++;
+	EXPECT_EQ(items, 2);
+
+	//renamed nodes lose their symbol until interned again
+	second_item->name("Other");
+	EXPECT_EQ(second_item->symbol(), 0u);
+	second_item->intern_name(symbols);
+	EXPECT_EQ(second_item->symbol(), doc1.first_node()->first_node()->symbol());
+
+	//table grows past its initial size
+	for (int i = 0; i < 1000; i++)
+	{
+		std::uint32_t symbol = symbols.intern(std::to_string(i).c_str());
+		EXPECT_EQ(symbols.find(std::to_string(i).c_str()), symbol);
+	}
+	EXPECT_EQ(symbols.find("Item"), item);
+	EXPECT_EQ(symbols.size(), 1005u);
+}
+#endif
+
+TEST(BasicTests, Vocabulary)
+{
+	enum tag { tag_unknown, tag_Message, tag_Header, tag_Body, tag_id, tag_priority };
+	static constexpr rapidxml::xml_vocabulary<char, 5> vocabulary({ "Message", "Header", "Body", "id", "priority" });
+	static_assert(vocabulary.find("Body") == tag_Body, "perfect hash built at compile time");
+	static_assert(vocabulary.find("Footer") == tag_unknown, "unknown names map to 0");
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+	char text[] = "<Message id=\"7\"><Header priority=\"high\" extra=\"1\"/><Body>text</Body><Trailer/></Message>";
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(text, vocabulary);
+
+	XMLElement* message = doc.first_node();
+	EXPECT_EQ(message->symbol(), static_cast<std::uint32_t>(tag_Message));
+	EXPECT_EQ(message->first_attribute()->symbol(), static_cast<std::uint32_t>(tag_id));
+	EXPECT_STREQ(message->first_node_by_symbol(tag_Body)->value(), "text");
+	EXPECT_STREQ(message->first_node_by_symbol(tag_Header)->first_attribute_by_symbol(tag_priority)->value(), "high");
+	EXPECT_EQ(message->first_node_by_symbol(tag_Header)->last_attribute()->symbol(), 0u);
+
+	int known = 0;
+	for (XMLElement* node = message->first_node(); node; node = node->next_sibling())
+	{
+		switch (node->symbol())
+		{
+		case tag_Header:
+		case tag_Body:
+			known++;
+			break;
+		case tag_unknown:
+			EXPECT_STREQ(node->name(), "Trailer");
+			break;
+		}
+	}
+	EXPECT_EQ(known, 2);
+#endif
+
+	//larger vocabularies still get a perfect hash
+	static constexpr const char* names[] = { "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7", "a8", "a9", "b0", "b1", "b2", "b3", "b4", "b5", "b6", "b7", "b8", "b9",
+		"c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7", "c8", "c9", "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7", "d8", "d9" };
+	static constexpr rapidxml::xml_vocabulary<char, 40> large(names);
+	for (std::uint32_t i = 0; i < 40; i++)
+		EXPECT_EQ(large.find(names[i]), i + 1);
+	EXPECT_EQ(large.find("e0"), 0u);
+}
+
+TEST(BasicTests, ChildIndex)
+{
+	std::string text = "<Root><Header/>";
+	for (int i = 0; i < 500; i++)
+		text += "<Item id=\"" + std::to_string(i) + "\"/><Other/>";
+	text += "<Footer/></Root>";
+
+	rapidxml::xml_document<> doc;
+	doc.parse<rapidxml::parse_index_wide_elements>(&text[0]);
+	XMLElement* root = doc.first_node();
+#ifdef RAPIDXML_CHILD_INDEX
+	EXPECT_TRUE(root->indexed_children());
+#endif
+	EXPECT_FALSE(root->first_node()->indexed_children());
+
+	EXPECT_STREQ(root->first_node("Item")->first_attribute("id")->value(), "0");
+	EXPECT_STREQ(root->last_node("Item")->first_attribute("id")->value(), "499");
+	EXPECT_EQ(root->first_node("Footer"), root->last_node());
+	EXPECT_EQ(root->first_node("Missing"), nullptr);
+	EXPECT_EQ(root->last_node("Missing"), nullptr);
+	EXPECT_EQ(root->first_node("item"), nullptr);
+	EXPECT_EQ(root->first_node("item", 0, false), root->first_node("Item"));
+
+	//walking same-named siblings through the index
+	int count = 0;
+	for (XMLElement* item = root->first_node("Item"); item; item = item->next_sibling("Item"))
+		EXPECT_EQ(atoi(item->first_attribute("id")->value()), count++);
+	EXPECT_EQ(count, 500);
+	EXPECT_EQ(root->first_node("Header")->next_sibling("Item"), root->first_node("Item"));
+	EXPECT_EQ(root->first_node("Item")->next_sibling("Other"), root->first_node("Item")->next_sibling());
+	EXPECT_EQ(root->first_node("Item")->next_sibling("Header"), nullptr);
+	EXPECT_EQ(root->first_node("Footer")->next_sibling("Footer"), nullptr);
+
+	//modification discards index, lookups stay correct
+	XMLElement* added = doc.allocate_node(rapidxml::node_type::node_element, "Item");
+	root->prepend_node(added);
+	EXPECT_FALSE(root->indexed_children());
+	EXPECT_EQ(root->first_node("Item"), added);
+	EXPECT_EQ(added->next_sibling("Item")->first_attribute("id")->value()[0], '0');
+
+	//index requested explicitly
+	doc.index_children(root);
+	EXPECT_EQ(root->first_node("Item"), added);
+	EXPECT_STREQ(added->next_sibling("Item")->first_attribute("id")->value(), "0");
+	root->remove_node(added);
+	EXPECT_STREQ(root->first_node("Item")->first_attribute("id")->value(), "0");
+
+	//renaming a child discards index, renaming an attribute does not
+	doc.index_children(root);
+	root->first_node("Item")->first_attribute()->name("key");
+#ifdef RAPIDXML_CHILD_INDEX
+	EXPECT_TRUE(root->indexed_children());
+#endif
+	root->last_node()->name("End");
+	EXPECT_FALSE(root->indexed_children());
+	EXPECT_EQ(root->first_node("Footer"), nullptr);
+	EXPECT_EQ(root->first_node("End"), root->last_node());
+
+	//rebuilding reuses memory of discarded index
+	doc.index_children(root);
+	char* before = doc.allocate_string(0, 1);
+	for (int i = 0; i < 10; i++)
+	{
+		root->last_node()->name(i % 2 ? "End" : "Footer");
+		doc.index_children(root);
+	}
+	EXPECT_EQ(doc.allocate_string(0, 1), before + RAPIDXML_ALIGNMENT);
+	EXPECT_EQ(root->first_node("Footer"), nullptr);
+	EXPECT_EQ(root->first_node("End"), root->last_node());
+	EXPECT_EQ(root->nth_child(1)->next_sibling("Item"), root->nth_child(3));
+}
+
+TEST(BasicTests, IdIndex)
+{
+	std::string text = "<Root>";
+	for (int i = 0; i < 300; i++)
+		text += "<Item id=\"item" + std::to_string(i) + "\" kind=\"k" + std::to_string(i) + "\"><Part key=\"part" + std::to_string(i) + "\"/></Item>";
+	text += "</Root>";
+
+	rapidxml::xml_id_index<> index;
+	index.add_attribute_name("id");
+	index.add_attribute_name("key");
+
+	rapidxml::xml_document<> doc;
+	doc.set_id_index(&index);
+	doc.parse<rapidxml::parse_id_index>(&text[0]);
+	EXPECT_EQ(index.size(), 600u);
+
+	XMLElement* item = doc.element_by_id("item42");
+	ASSERT_NE(item, nullptr);
+	EXPECT_STREQ(item->first_attribute("kind")->value(), "k42");
+	EXPECT_EQ(doc.element_by_id("part42"), item->first_node());
+	EXPECT_EQ(doc.element_by_id("k42"), nullptr);
+	EXPECT_EQ(doc.element_by_id("item300"), nullptr);
+	EXPECT_EQ(doc.element_by_id("item42xyz", 6), item);
+
+	//attributes removed from the document leave the index
+	item->remove_attribute(item->first_attribute("id"));
+	EXPECT_EQ(doc.element_by_id("item42"), nullptr);
+	EXPECT_EQ(index.size(), 599u);
+
+	//attributes added to the document enter it
+	item->append_attribute(doc.allocate_attribute("id", "renamed"));
+	EXPECT_EQ(doc.element_by_id("renamed"), item);
+	item->remove_all_attributes();
+	EXPECT_EQ(doc.element_by_id("renamed"), nullptr);
+
+	//detached attributes and nodes are not indexed or found
+	XMLElement* detached = doc.allocate_node(rapidxml::node_type::node_element, "Detached");
+	detached->append_attribute(doc.allocate_attribute("id", "detached"));
+	EXPECT_EQ(doc.element_by_id("detached"), nullptr);
+	XMLElement* removed = doc.element_by_id("item7");
+	doc.first_node()->remove_node(removed);
+	EXPECT_EQ(doc.element_by_id("item7"), nullptr);
+	EXPECT_EQ(index.size(), 597u);
+
+	//removed subtrees leave the index, so repeated editing does not grow it
+	for (int i = 0; i < 100; i++)
+	{
+		XMLElement* temporary = doc.allocate_node(rapidxml::node_type::node_element, "Temporary");
+		doc.first_node()->append_node(temporary);
+		temporary->append_attribute(doc.allocate_attribute("id", "temporary"));
+		EXPECT_EQ(doc.element_by_id("temporary"), temporary);
+		doc.first_node()->remove_node(temporary);
+		doc.free_node(temporary);
+	}
+	EXPECT_EQ(index.size(), 597u);
+
+	//attached subtree is indexed by rebuild, which compaction does
+	doc.first_node()->append_node(detached);
+	EXPECT_EQ(doc.element_by_id("detached"), nullptr);
+	doc.compact();
+	EXPECT_NE(doc.element_by_id("detached"), nullptr);
+	EXPECT_STREQ(doc.element_by_id("item8")->first_attribute("kind")->value(), "k8");
+	EXPECT_EQ(doc.element_by_id("item7"), nullptr);
+
+	//index is emptied by clear and parse
+	doc.clear();
+	EXPECT_EQ(index.size(), 0u);
+	EXPECT_EQ(doc.element_by_id("item8"), nullptr);
+
+	//attributes moved into contiguous arrays are indexed at their final place, even when freed attributes are reused
+	doc.free_attribute(doc.allocate_attribute("unused"));
+	std::string contiguous = "<r a=\"1\" id=\"x\" b=\"2\"><c id=\"y\"/></r>";
+	doc.parse<rapidxml::parse_id_index | rapidxml::parse_contiguous_attributes>(&contiguous[0]);
+	EXPECT_EQ(index.size(), 2u);
+	EXPECT_EQ(doc.element_by_id("x"), doc.first_node());
+	EXPECT_EQ(doc.element_by_id("y"), doc.first_node()->first_node());
+
+	//documents without the flag leave the index empty
+	std::string other = "<Root id=\"root\"/>";
+	doc.parse<0>(&other[0]);
+	EXPECT_EQ(doc.element_by_id("root"), nullptr);
+	doc.set_id_index(&index);
+	EXPECT_EQ(doc.element_by_id("root"), doc.first_node());
+}
+
+TEST(BasicTests, OrderedIndex)
+{
+	//timestamps in reverse document order, with every tenth element lacking one and some duplicates
+	std::string text = "<Log>";
+	for (int i = 0; i < 20000; i++)
+	{
+		if (i % 10 == 9)
+			text += "<Entry/>";
+		else
+			text += "<Entry time=\"" + std::to_string((20000 - i) / 2) + "\" level=\" " + std::to_string(i % 7) + ".5 \"><Source>s" + std::to_string(i % 100) + "</Source></Entry>";
+	}
+	text += "<Other time=\"5\"/></Log>";
+
+	std::string copy = text;
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(&text[0]);
+
+	rapidxml::xml_ordered_index<> byTime(rapidxml::key_type::key_integer);
+	byTime.build(&doc, "Entry", "time");
+	EXPECT_EQ(byTime.size(), 18000u);
+	std::int64_t previous = -1;
+	size_t count = 0;
+	for (XMLElement* node : byTime.integer_range(100, 200))
+	{
+		std::int64_t time = atoll(node->first_attribute("time")->value());
+		EXPECT_GE(time, 100);
+		EXPECT_LE(time, 200);
+		EXPECT_GE(time, previous);
+		previous = time;
+		count++;
+	}
+	EXPECT_EQ(count, byTime.integer_range(100, 200).size());
+	EXPECT_GT(count, 150u);
+	EXPECT_TRUE(byTime.integer_range(200, 100).empty());
+	EXPECT_TRUE(byTime.integer_range(20000, 30000).empty());
+
+	//equal keys keep document order
+	auto same = byTime.integer_range(5001, 5001);
+	ASSERT_EQ(same.size(), 2u);
+	XMLElement* first = *same.begin();
+	EXPECT_EQ(first->next_sibling(), *++same.begin());
+
+	//parallel build gives the same order
+	rapidxml::xml_ordered_index<> parallel(rapidxml::key_type::key_integer);
+	parallel.build(&doc, "Entry", "time", 4);
+	EXPECT_TRUE(std::equal(byTime.all().begin(), byTime.all().end(), parallel.all().begin()));
+
+	//floating point keys, surrounded by whitespace
+	rapidxml::xml_ordered_index<> byLevel(rapidxml::key_type::key_float);
+	byLevel.build(&doc, "Entry", "level", 0);
+	EXPECT_EQ(byLevel.float_range(2.0, 3.0).size(), byLevel.float_range(2.5, 2.5).size());
+	EXPECT_STREQ((*byLevel.float_range(6.0, 100.0).begin())->first_attribute("level")->value(), " 6.5 ");
+
+	//string keys from child elements
+	rapidxml::xml_ordered_index<> bySource(rapidxml::key_type::key_string, rapidxml::key_source::key_child);
+	bySource.build(&doc, "Entry", "Source");
+	EXPECT_EQ(bySource.string_equal("s42").size(), 200u);
+	EXPECT_EQ(bySource.string_range("s1", "s2").size(), bySource.string_range("s1", "s19").size() + 200u);
+
+	//all elements
+	rapidxml::xml_ordered_index<> any(rapidxml::key_type::key_integer);
+	any.build(&doc, nullptr, "time");
+	EXPECT_EQ(any.size(), 18001u);
+
+	//saved positions restore the index over the same text parsed again
+	std::vector<std::uint32_t> saved;
+	byTime.save(std::back_inserter(saved));
+	rapidxml::xml_document<> again;
+	again.parse<0>(&copy[0]);
+	rapidxml::xml_ordered_index<> loaded(rapidxml::key_type::key_integer);
+	EXPECT_TRUE(loaded.load(&again, "Entry", "time", saved.begin(), saved.end()));
+	EXPECT_EQ(loaded.integer_range(100, 200).size(), count);
+	EXPECT_EQ((*loaded.integer_range(5001, 5001).begin())->first_attribute("time")->value(), std::string("5001"));
+	std::swap(saved[0], saved[1]);
+	EXPECT_FALSE(loaded.load(&again, "Entry", "time", saved.begin(), saved.end()));
+	EXPECT_EQ(loaded.size(), 0u);
+}
+
+TEST(BasicTests, Query)
+{
+	std::string text =
+		"<Root>"
+		"<Items kind=\"a\"><Item id=\"1\"><Name>one</Name></Item><Item><Name>two</Name></Item><Item id=\"3\">three<![CDATA[!]]></Item></Items>"
+		"<Items kind=\"b\"><Item id=\"4\"><Name>four</Name><Item id=\"5\"/></Item></Items>"
+		"<Other><Item id=\"6\"/></Other>"
+		"</Root>";
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(&text[0]);
+	XMLElement* root = doc.first_node();
+
+	auto ids = [&](const char* path, XMLElement* context)
+	{
+		std::string result;
+		rapidxml::xml_query<>(path).for_each(context, [&](XMLElement* node)
+		{
+			XMLAttributte* id = node->first_attribute("id");
+			result += id ? id->value() : "-";
+		});
+		return result;
+	};
+
+	EXPECT_EQ(ids("Root/Items/Item", &doc), "1-34");
+	EXPECT_EQ(ids("Items/Item", root), "1-34");
+	EXPECT_EQ(ids("/Root/Items/Item", root->first_node()), "1-34");
+	EXPECT_EQ(ids("//Item", &doc), "1-3456");
+	EXPECT_EQ(ids("Root//Item/Item", &doc), "5");
+	EXPECT_EQ(ids("Root/*/Item", &doc), "1-346");
+	EXPECT_EQ(ids("Root/Items/Item[2]", &doc), "-");
+	EXPECT_EQ(ids("//Item[1]", &doc), "1456");
+	EXPECT_EQ(ids("Root/Items/Item[@id]", &doc), "134");
+	EXPECT_EQ(ids("Root/Items/Item[@id][2]", &doc), "3");
+	EXPECT_EQ(ids("Root/Items/Item[2][@id]", &doc), "");
+	EXPECT_EQ(ids("Root/Items[@kind='b']/Item", &doc), "4");
+	EXPECT_EQ(ids("Root/Items/Item[Name]", &doc), "1-4");
+	EXPECT_EQ(ids("Root/Items/Item[ Name = \"two\" ]", &doc), "-");
+	EXPECT_EQ(ids("//Item[text()='three']", &doc), "3");
+	EXPECT_EQ(ids("Root/Missing//Item", &doc), "");
+
+	//text() selects data and CDATA nodes
+	rapidxml::xml_query<> texts("//Item[@id='3']/text()");
+	EXPECT_EQ(texts.step_count(), 2u);
+	EXPECT_EQ(texts.count(&doc), 2u);
+	EXPECT_EQ(texts.first(&doc)->type(), rapidxml::node_type::node_data);
+	EXPECT_STREQ(texts.first(&doc)->value(), "three");
+
+	//stopping early
+	int visited = 0;
+	EXPECT_FALSE(rapidxml::xml_query<>("//Item").for_each(&doc, [&](XMLElement*) { return ++visited < 2; }));
+	EXPECT_EQ(visited, 2);
+
+	//syntax errors point into the query
+	const char* bad = "Root/Items[@id='1'/Item";
+	try
+	{
+		rapidxml::xml_query<> query(bad);
+		FAIL();
+	}
+	catch (const rapidxml::parse_error& e)
+	{
+		EXPECT_STREQ(e.what(), "expected ]");
+		EXPECT_EQ(e.where<const char>(), bad + 18);
+	}
+	EXPECT_THROW(rapidxml::xml_query<>("Root//"), rapidxml::parse_error);
+	EXPECT_THROW(rapidxml::xml_query<>("text()/Item"), rapidxml::parse_error);
+	EXPECT_THROW(rapidxml::xml_query<>("Item[0]"), rapidxml::parse_error);
+
+	std::string error;
+	EXPECT_EQ(SelectFirstElement(&doc, "Root/Items[@kind='b']/Item/Item", error)->first_attribute("id")->value(), std::string("5"));
+	EXPECT_EQ(SelectFirstElement(&doc, "Root/[", error), nullptr);
+	EXPECT_EQ(error, "expected name");
+}
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+TEST(BasicTests, StaticSelect)
+{
+	std::string text = "<Root><Other/><ElementArray><Element id=\"1\"/><Element id=\"2\"/></ElementArray></Root>";
+	rapidxml::xml_document<> doc;
+	doc.parse<rapidxml::parse_name_hashes>(&text[0]);
+
+	XMLElement* element = rapidxml::select<"Root/ElementArray/Element">(&doc);
+	ASSERT_NE(element, nullptr);
+	EXPECT_STREQ(element->first_attribute("id")->value(), "1");
+	EXPECT_EQ(element, doc.first_node("Root")->first_node("ElementArray")->first_node("Element"));
+	EXPECT_EQ(rapidxml::select<"ElementArray/Element">(doc.first_node()), element);
+	EXPECT_EQ(rapidxml::select<"/Root/ElementArray">(element), element->parent());
+	EXPECT_EQ(rapidxml::select<"Root/Missing/Element">(&doc), nullptr);
+	EXPECT_EQ(rapidxml::select<"Root/Element">(&doc), nullptr);
+
+	//nodes created after parsing have no hashes
+	XMLElement* added = doc.allocate_node(rapidxml::node_type::node_element, "Added");
+	element->append_node(added);
+	EXPECT_EQ(rapidxml::select<"Root/ElementArray/Element/Added">(&doc), added);
+}
+#endif
+
+TEST(BasicTests, QueryCache)
+{
+	std::string text = "<Root><Items><Item id=\"1\"/><Item id=\"2\"/></Items><Items><Item id=\"3\"/></Items></Root>";
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(&text[0]);
+	XMLElement* root = doc.first_node();
+
+	rapidxml::xml_query_cache<> cache(doc);
+	rapidxml::xml_query<> items("Root/Items/Item");
+	auto first = cache.select(items, &doc);
+	EXPECT_EQ(first.size(), 3u);
+	EXPECT_STREQ(first[2]->first_attribute("id")->value(), "3");
+	EXPECT_EQ(cache.size(), 1u);
+
+	//same query text and context hits the cache, other contexts do not
+	auto again = cache.select(rapidxml::xml_query<>("Root/Items/Item"), &doc);
+	EXPECT_EQ(again.begin(), first.begin());
+	EXPECT_EQ(cache.select(rapidxml::xml_query<>("Item"), root->first_node()).size(), 2u);
+	EXPECT_EQ(cache.select(rapidxml::xml_query<>("Item"), root->last_node()).size(), 1u);
+	EXPECT_EQ(cache.first(rapidxml::xml_query<>("Missing"), &doc), nullptr);
+	EXPECT_EQ(cache.size(), 4u);
+
+	//many distinct entries
+	for (int i = 0; i < 200; i++)
+		cache.select(rapidxml::xml_query<>(("//Item[" + std::to_string(i % 3 + 1) + "][@id]").c_str()), i < 100 ? static_cast<XMLElement*>(&doc) : root);
+	EXPECT_EQ(cache.size(), 10u);
+
+	//detached nodes do not affect the document
+	size_t generation = doc.generation();
+	XMLElement* added = doc.allocate_node(rapidxml::node_type::node_element, "Item");
+	added->append_attribute(doc.allocate_attribute("id", "4"));
+	added->value("text");
+	EXPECT_EQ(doc.generation(), generation);
+	EXPECT_EQ(cache.size(), 10u);
+
+	//any modification of the document empties the cache
+	root->last_node()->append_node(added);
+	EXPECT_NE(doc.generation(), generation);
+	EXPECT_EQ(cache.size(), 0u);
+	EXPECT_EQ(cache.select(items, &doc).size(), 4u);
+	EXPECT_EQ(cache.size(), 1u);
+
+	generation = doc.generation();
+	added->first_attribute()->value("5");
+	EXPECT_NE(doc.generation(), generation);
+	generation = doc.generation();
+	added->name("Other");
+	EXPECT_NE(doc.generation(), generation);
+	EXPECT_EQ(cache.select(items, &doc).size(), 3u);
+	generation = doc.generation();
+	root->remove_node(root->first_node());
+	EXPECT_NE(doc.generation(), generation);
+	EXPECT_EQ(cache.select(items, &doc).size(), 1u);
+	generation = doc.generation();
+	doc.compact();
+	EXPECT_NE(doc.generation(), generation);
+	EXPECT_STREQ(cache.first(items, &doc)->first_attribute("id")->value(), "3");
+
+	//documents start tracking changes of nodes parsed or attached earlier once their generation is read
+	std::string other = "<Root><A><B/></A></Root>";
+	rapidxml::xml_document<> tracked;
+	tracked.parse<0>(&other[0]);
+	XMLElement* subtree = tracked.allocate_node(rapidxml::node_type::node_element, "C");
+	subtree->append_node(tracked.allocate_node(rapidxml::node_type::node_element, "D"));
+	tracked.first_node()->append_node(subtree);
+	generation = tracked.generation();
+	tracked.first_node()->first_node()->first_node()->name("E");
+	EXPECT_NE(tracked.generation(), generation);
+	generation = tracked.generation();
+	subtree->first_node()->value("text");
+	EXPECT_NE(tracked.generation(), generation);
+
+	//subtrees attached to a tracked document are tracked as a whole
+	subtree = tracked.allocate_node(rapidxml::node_type::node_element, "F");
+	subtree->append_node(tracked.allocate_node(rapidxml::node_type::node_element, "G"));
+	subtree->first_node()->append_node(tracked.allocate_node(rapidxml::node_type::node_element, "H"));
+	tracked.first_node()->prepend_node(subtree);
+	generation = tracked.generation();
+	subtree->first_node()->first_node()->append_attribute(tracked.allocate_attribute("a", "1"));
+	EXPECT_NE(tracked.generation(), generation);
+}
+
+TEST(BasicTests, Iterators)
+{
+	std::string text = "<Root a=\"1\" b=\"2\"><A><B/>text<C><B/></C></A><B><A/></B><!--x--><D/></Root>";
+	rapidxml::xml_document<> doc;
+	doc.parse<rapidxml::parse_comment_nodes>(&text[0]);
+	XMLElement* root = doc.first_node();
+
+	//children and attributes, in both directions
+	std::string names;
+	for (rapidxml::node_iterator<char> it(root), end; it != end; it++)
+		names += it->name_size() ? it->name() : "#";
+	EXPECT_EQ(names, "AB#D");
+	rapidxml::node_iterator<char> child(root);
+	child++;
+	child--;
+	EXPECT_STREQ(child->name(), "A");
+	rapidxml::attribute_iterator<char> attribute(root);
+	EXPECT_STREQ((attribute++)->name(), "a");
+	EXPECT_STREQ(attribute->name(), "b");
+	attribute--;
+	EXPECT_STREQ((*attribute).name(), "a");
+
+	//descendants, with and without links in document order
+	auto walk = [](rapidxml::descendant_iterator<char> it)
+	{
+		std::string result;
+		for (rapidxml::descendant_iterator<char> end; it != end; ++it)
+			result += it->type() == rapidxml::node_type::node_element ? it->name() : it->type() == rapidxml::node_type::node_data ? "$" : "#";
+		return result;
+	};
+	for (int linked = 0; linked < 2; linked++)
+	{
+		if (linked)
+		{
+			text = "<Root a=\"1\" b=\"2\"><A><B/>text<C><B/></C></A><B><A/></B><!--x--><D/></Root>";
+			doc.parse<rapidxml::parse_comment_nodes | rapidxml::parse_document_order>(&text[0]);
+			root = doc.first_node();
+		}
+#ifdef RAPIDXML_DOCUMENT_ORDER
+		EXPECT_EQ(doc.document_order_linked(), linked == 1);
+#else
+		EXPECT_FALSE(doc.document_order_linked());
+#endif
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(&doc)), "RootAB$CBBA#D");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(root->first_node())), "B$CB");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(root->first_node()->last_node())), "B");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(root->last_node())), "");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(&doc, "B")), "BBB");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(&doc, rapidxml::node_type::node_element)), "RootABCBBAD");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(root, rapidxml::node_type::node_comment)), "#");
+		EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(root, rapidxml::node_type::node_element, "A")), "AA");
+
+		//skipping subtrees
+		std::string skipped;
+		for (rapidxml::descendant_iterator<char> it(root, rapidxml::node_type::node_element), end; it != end; ++it)
+		{
+			skipped += it->name();
+			if (it->name()[0] == 'A')
+				it.skip_children();
+		}
+		EXPECT_EQ(skipped, "ABAD");
+	}
+
+	//modification invalidates links until they are restored
+	root->first_node()->append_node(doc.allocate_node(rapidxml::node_type::node_element, "E"));
+	EXPECT_FALSE(doc.document_order_linked());
+	EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(root->first_node(), rapidxml::node_type::node_element)), "BCBE");
+	doc.link_document_order();
+#ifdef RAPIDXML_DOCUMENT_ORDER
+	EXPECT_TRUE(doc.document_order_linked());
+#else
+	EXPECT_FALSE(doc.document_order_linked());
+#endif
+	EXPECT_EQ(root->first_node()->last_node()->next_in_document_order(), root->first_node()->next_sibling());
+	EXPECT_EQ(root->last_node()->next_in_document_order(), nullptr);
+	EXPECT_EQ(walk(rapidxml::descendant_iterator<char>(&doc)), "RootAB$CBEBA#D");
+}
+
+TEST(BasicTests, ChildCounts)
+{
+	std::string text = "<Root a=\"1\" b=\"2\">";
+	for (int i = 0; i < 1000; i++)
+		text += "<Item key=\"" + std::to_string(i * 2) + "\"/>";
+	text += "</Root>";
+
+	rapidxml::xml_document<> doc;
+	doc.parse<rapidxml::parse_index_wide_elements>(&text[0]);
+	XMLElement* root = doc.first_node();
+#ifdef RAPIDXML_CHILD_INDEX
+	ASSERT_TRUE(root->indexed_children());
+#endif
+	EXPECT_EQ(rapidxml::count_children(root), 1000u);
+	EXPECT_EQ(rapidxml::count_attributes(root), 2u);
+	EXPECT_STREQ(root->nth_child(500)->first_attribute("key")->value(), "1000");
+	EXPECT_EQ(root->nth_child(999), root->last_node());
+	EXPECT_EQ(root->nth_child(1000), nullptr);
+
+	//binary search over children sorted by key
+	auto less = [](const XMLElement& child, int key) { return atoi(child.first_attribute("key")->value()) < key; };
+	EXPECT_STREQ(rapidxml::lower_bound_child(root, 777, less)->first_attribute("key")->value(), "778");
+	EXPECT_EQ(rapidxml::lower_bound_child(root, 0, less), root->first_node());
+	EXPECT_EQ(rapidxml::lower_bound_child(root, 2000, less), nullptr);
+
+	//counts follow modifications, positional access walks once index is discarded
+	XMLElement* added = doc.allocate_node(rapidxml::node_type::node_element, "Item");
+	root->insert_node(root->nth_child(10), added);
+	root->remove_node(root->first_node());
+	root->remove_last_node();
+	root->append_attribute(doc.allocate_attribute("c", "3"));
+	root->remove_first_attribute();
+	EXPECT_FALSE(root->indexed_children());
+	EXPECT_EQ(root->child_count(), 999u);
+	EXPECT_EQ(root->attribute_count(), 2u);
+	EXPECT_EQ(root->nth_child(9), added);
+	EXPECT_STREQ(root->nth_child(900)->first_attribute("key")->value(), "1800");
+	EXPECT_STREQ(rapidxml::lower_bound_child(root, 5, less)->first_attribute("key")->value(), "6");
+	root->remove_all_nodes();
+	root->remove_all_attributes();
+	EXPECT_EQ(root->child_count(), 0u);
+	EXPECT_EQ(root->attribute_count(), 0u);
+	EXPECT_EQ(root->nth_child(0), nullptr);
+
+	//contiguous attributes and compaction keep counts
+	std::string attributes = "<Root><Item a=\"1\" b=\"2\" c=\"3\"/><Item/></Root>";
+	rapidxml::xml_document<> other;
+	other.parse<rapidxml::parse_contiguous_attributes>(&attributes[0]);
+	other.compact();
+	EXPECT_EQ(other.child_count(), 1u);
+	EXPECT_EQ(other.first_node()->child_count(), 2u);
+	EXPECT_EQ(other.first_node()->first_node()->attribute_count(), 3u);
+}
+
+TEST(BasicTests, Parallel)
+{
+	std::string text = "<Root>";
+	for (int i = 0; i < 100; i++)
+	{
+		text += "<Group>";
+		for (int j = 0; j < 200; j++)
+			text += "<Item id=\"" + std::to_string(i * 200 + j) + "\"><Value>" + std::to_string(j) + "</Value></Item>";
+		text += "</Group>";
+	}
+	text += "<Deep>";
+	for (int i = 0; i < 50; i++)
+		text += "<Item id=\"deep" + std::to_string(i) + "\"><Item/><Item/>";
+	for (int i = 0; i < 50; i++)
+		text += "</Item>";
+	text += "</Deep></Root>";
+
+	rapidxml::xml_id_index<> index;
+	index.add_attribute_name("id");
+	rapidxml::xml_document<> doc;
+	doc.set_id_index(&index);
+	doc.parse<rapidxml::parse_id_index>(&text[0]);
+	XMLElement* root = doc.first_node();
+
+	//read-only traversal
+	std::atomic<std::size_t> visited(0), items(0);
+	rapidxml::parallel_for_each_descendant(root, [&](XMLElement& node)
+	{
+		++visited;
+		if (node.name_size() == 4 && node.name()[0] == 'I')
+			++items;
+	}, 4);
+	EXPECT_EQ(items.load(), 20000u + 150u);
+	EXPECT_EQ(visited.load(), 100u + 20000u * 3 + 1 + 150u);
+
+	//transformation of each item's own subtree, allocating from per-thread sub-pools
+	std::size_t generation = doc.generation();
+	rapidxml::parallel_transform(root, doc, [](XMLElement& node, rapidxml::memory_pool<>& pool)
+	{
+		if (std::string(node.name()) != "Item" || !node.first_attribute("id"))
+			return;
+		std::string copy = std::string("copy") + node.first_attribute("id")->value();
+		node.append_attribute(pool.allocate_attribute("ref", pool.allocate_string(copy.c_str())));
+		XMLElement* added = pool.allocate_node(rapidxml::node_type::node_element, "Added");
+		added->append_attribute(pool.allocate_attribute("id", pool.allocate_string(copy.c_str())));
+		node.append_node(added);
+	}, 4);
+	EXPECT_GT(doc.generation(), generation);
+	EXPECT_FALSE(doc.updates_deferred());
+	XMLElement* item = doc.element_by_id("12345");
+	ASSERT_NE(item, nullptr);
+	EXPECT_STREQ(item->first_attribute("ref")->value(), "copy12345");
+	EXPECT_EQ(doc.element_by_id("copy12345"), item->first_node("Added"));
+	EXPECT_EQ(item->child_count(), 2u);
+	XMLElement* deep = doc.element_by_id("deep49");
+	ASSERT_NE(deep, nullptr);
+	EXPECT_STREQ(deep->first_node("Added")->first_attribute("id")->value(), "copydeep49");
+
+	//exceptions thrown by the function reach the caller
+	EXPECT_THROW(rapidxml::parallel_for_each_descendant(root, [](XMLElement& node)
+	{
+		if (node.first_attribute("id") && std::string(node.first_attribute("id")->value()) == "777")
+			throw std::runtime_error("stop");
+	}, 3), std::runtime_error);
+}
+
+TEST(BasicTests, ConcurrentPool)
+{
+	rapidxml::concurrent_memory_pool<> pool;
+	rapidxml::xml_document<> doc;
+	XMLElement* root = doc.allocate_node(rapidxml::node_type::node_element, "Root");
+	doc.append_node(root);
+
+	//each thread builds its own subtree from the shared pool
+	const int threads = 8, items = 5000;
+	std::vector<XMLElement*> parts(threads);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++)
+		workers.emplace_back([&, t]()
+		{
+			XMLElement* part = pool.allocate_node(rapidxml::node_type::node_element, "Part");
+			for (int i = 0; i < items; i++)
+			{
+				std::string value = std::to_string(t * items + i);
+				XMLElement* item = pool.allocate_node(rapidxml::node_type::node_element, "Item");
+				item->append_attribute(pool.allocate_attribute("id", pool.allocate_string(value.c_str())));
+				if (i % 100 == 0)
+					item->value(pool.allocate_string(0, 10000), 10000);
+				part->append_node(item);
+			}
+			parts[t] = part;
+		});
+	for (std::thread& worker : workers)
+		worker.join();
+	for (XMLElement* part : parts)
+		root->append_node(part);
+
+	EXPECT_EQ(root->child_count(), 8u);
+	std::size_t count = 0;
+	for (XMLElement* part = root->first_node(); part; part = part->next_sibling())
+		for (XMLElement* item = part->first_node(); item; item = item->next_sibling())
+		{
+			EXPECT_EQ(reinterpret_cast<std::size_t>(item) % RAPIDXML_ALIGNMENT, 0u);
+			EXPECT_EQ(atoi(item->first_attribute("id")->value()) % items, static_cast<int>(count++ % items));
+		}
+	EXPECT_EQ(count, static_cast<std::size_t>(threads * items));
+
+	//pool is reusable after clear
+	doc.clear();
+	pool.clear();
+	XMLElement* node = pool.allocate_node(rapidxml::node_type::node_element, "Again", pool.allocate_string("value"));
+	EXPECT_STREQ(node->value(), "value");
+
+	//pools whose stamps fall into the same slot keep a region each on a thread alternating between them
+	rapidxml::concurrent_memory_pool<> pools[5];
+	const ptrdiff_t stride = (sizeof(XMLElement) + RAPIDXML_ALIGNMENT - 1) & ~ptrdiff_t(RAPIDXML_ALIGNMENT - 1);
+	XMLElement* first = pools[0].allocate_node(rapidxml::node_type::node_element);
+	pools[4].allocate_node(rapidxml::node_type::node_element);
+	XMLElement* second = pools[0].allocate_node(rapidxml::node_type::node_element);
+	EXPECT_EQ(reinterpret_cast<char*>(second) - reinterpret_cast<char*>(first), stride);
+}
+
+TEST(BasicTests, Adopt)
+{
+	rapidxml::xml_document<> doc;
+	std::string header = "<Output><Header/></Output>";
+	doc.parse<0>(doc.allocate_string(header.c_str()));
+	XMLElement* output = doc.first_node();
+
+	//fragments are parsed from text copied into their own pools, then spliced; those in embedded static memory are copied out of it first
+	for (int i = 0; i < 50; i++)
+	{
+		rapidxml::xml_document<> fragment;
+		std::string text = "<Fragment id=\"" + std::to_string(i) + "\"><Data>" + std::string(i * 100, 'x') + "</Data></Fragment>";
+		fragment.parse<0>(fragment.allocate_string(text.c_str()));
+		doc.adopt(fragment);
+		XMLElement* node = fragment.first_node();
+		fragment.remove_node(node);
+		output->append_node(node);
+	}
+
+	EXPECT_EQ(output->child_count(), 51u);
+	std::string result;
+	rapidxml::print(std::back_inserter(result), doc, rapidxml::print_no_indenting);
+	EXPECT_NE(result.find("<Header/><Fragment id=\"0\"><Data/></Fragment><Fragment id=\"1\">"), std::string::npos);
+	EXPECT_NE(result.find("<Fragment id=\"7\"><Data>" + std::string(700, 'x') + "</Data></Fragment>"), std::string::npos);
+	EXPECT_STREQ(output->last_node()->first_attribute("id")->value(), "49");
+
+	//adopted pool is empty and usable again
+	rapidxml::memory_pool<> pool;
+	XMLElement* kept = pool.allocate_node(rapidxml::node_type::node_element, pool.allocate_string("Kept"));
+	pool.allocate_string(0, 100000);
+	doc.adopt(pool);
+	EXPECT_EQ(pool.allocate_node(rapidxml::node_type::node_element)->first_node(), nullptr);
+	pool.clear();
+	EXPECT_STREQ(kept->name(), "Kept");
+
+	//pools with static memory adopt into it when they have no blocks yet
+	char buffer[1024];
+	rapidxml::memory_pool<> with_static(buffer, sizeof(buffer));
+	XMLElement* small = with_static.allocate_node(rapidxml::node_type::node_element, "Small");
+	rapidxml::memory_pool<> source;
+	XMLElement* adopted = source.allocate_node(rapidxml::node_type::node_element, source.allocate_string("Adopted"));
+	with_static.adopt(source);
+	source.clear();
+	EXPECT_STREQ(small->name(), "Small");
+	EXPECT_STREQ(adopted->name(), "Adopted");
+	with_static.allocate_string(0, 200000);
+	EXPECT_STREQ(adopted->name(), "Adopted");
+
+	//static memory of a plain pool cannot be adopted
+	char other_buffer[1024];
+	rapidxml::memory_pool<> static_source(other_buffer, sizeof(other_buffer));
+	static_source.allocate_node(rapidxml::node_type::node_element, "Static");
+	EXPECT_THROW(with_static.adopt(static_source), rapidxml::parse_error);
+
+	//fragments without static memory are adopted without copying
+	rapidxml::xml_document<char, 0> plain;
+	plain.parse<0>(plain.allocate_string("<Plain/>"));
+	XMLElement* kept_plain = plain.first_node();
+	doc.adopt(plain);
+	plain.remove_node(kept_plain);
+	output->append_node(kept_plain);
+	EXPECT_STREQ(output->last_node()->name(), "Plain");
+
+	//pools set up with the same allocation functions adopt each other's memory
+	rapidxml::memory_pool<> allocated, other_allocated;
+	allocated.set_allocator(malloc, free);
+	other_allocated.set_allocator(malloc, free);
+	XMLElement* freed = other_allocated.allocate_node(rapidxml::node_type::node_element, other_allocated.allocate_string(0, 100000));
+	allocated.adopt(other_allocated);
+	other_allocated.clear();
+	freed->name()[99999] = 'x';
+}
+
+TEST(BasicTests, DeepClone)
+{
+	rapidxml::xml_document<> target;
+	XMLElement* root = target.allocate_node(rapidxml::node_type::node_element, "Root");
+	target.append_node(root);
+	std::string expected;
+	{
+		rapidxml::xml_document<> source;
+		std::string text = "<Template kind=\"a\" size=\"2\"><Row><Cell>1</Cell><Cell>2</Cell></Row><!--note--><Row/></Template>";
+		source.parse<rapidxml::parse_comment_nodes>(&text[0]);
+		rapidxml::print(std::back_inserter(expected), *source.first_node(), rapidxml::print_no_indenting);
+
+		//stamp the template several times; the clones outlive the source document and its text
+		for (int i = 0; i < 3; i++)
+			root->append_node(target.deep_clone(source.first_node()));
+		text.assign(text.size(), ' ');
+	}
+	EXPECT_EQ(root->child_count(), 3u);
+	for (XMLElement* clone = root->first_node(); clone; clone = clone->next_sibling())
+	{
+		std::string actual;
+		rapidxml::print(std::back_inserter(actual), *clone, rapidxml::print_no_indenting);
+		EXPECT_EQ(actual, expected);
+		EXPECT_TRUE(clone->contiguous_attributes());
+		EXPECT_EQ(clone->first_node()->child_count(), 2u);
+	}
+
+	//nodes of a clone follow each other in document order
+	XMLElement* clone = root->first_node();
+	EXPECT_EQ(clone->first_node(), clone + 1);
+	EXPECT_EQ(clone->first_node()->first_node(), clone + 2);
+
+	//deep trees are cloned without recursion
+	rapidxml::memory_pool<> pool;
+	XMLElement* chain = pool.allocate_node(rapidxml::node_type::node_element, "Leaf");
+	for (int i = 0; i < 200000; i++)
+	{
+		XMLElement* parent = pool.allocate_node(rapidxml::node_type::node_element, "Link");
+		parent->append_node(chain);
+		chain = parent;
+	}
+	XMLElement* copy = target.deep_clone(chain);
+	pool.clear();
+	int depth = 0;
+	while (copy->first_node())
+	{
+		copy = copy->first_node();
+		++depth;
+	}
+	EXPECT_EQ(depth, 200000);
+	EXPECT_STREQ(copy->name(), "Leaf");
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+	//symbol IDs are interned again when cloning between documents with different symbol tables
+	rapidxml::xml_symbol_table<> first_symbols, second_symbols;
+	second_symbols.intern("Unrelated");
+	rapidxml::xml_document<> first, second;
+	first.set_symbol_table(&first_symbols);
+	second.set_symbol_table(&second_symbols);
+	std::string interned = "<Row cell=\"1\"><Cell/></Row>";
+	first.parse<rapidxml::parse_intern_names>(&interned[0]);
+	XMLElement* row = first.first_node();
+	XMLElement* moved = second.deep_clone(row);
+	EXPECT_NE(moved->symbol(), row->symbol());
+	EXPECT_EQ(moved->symbol(), second_symbols.find("Row"));
+	EXPECT_EQ(moved->first_attribute()->symbol(), second_symbols.find("cell"));
+	EXPECT_EQ(moved->first_node()->symbol(), second_symbols.find("Cell"));
+
+	//and kept within the same document, or cleared without a symbol table
+	EXPECT_EQ(first.deep_clone(row)->first_node()->symbol(), row->first_node()->symbol());
+	EXPECT_EQ(target.deep_clone(row)->symbol(), 0u);
+	EXPECT_EQ(target.deep_clone(row)->first_attribute()->symbol(), 0u);
+#endif
+}
+
+static rapidxml::xml_document<> ParseCopy(const std::string& text)
+{
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(doc.allocate_string(text.c_str()));
+	return doc;
+}
+
+TEST(BasicTests, DocumentMove)
+{
+	static_assert(std::is_move_constructible<rapidxml::xml_document<>>::value && std::is_move_assignable<rapidxml::xml_document<>>::value);
+	static_assert(!std::is_copy_constructible<rapidxml::xml_document<>>::value && !std::is_copy_assignable<rapidxml::xml_document<>>::value);
+
+	//documents are returned by value and kept in containers
+	std::vector<rapidxml::xml_document<>> docs;
+	for (int i = 0; i < 20; i++)
+		docs.push_back(ParseCopy("<Doc n=\"" + std::to_string(i) + "\"><Item/><Item/></Doc>"));
+	for (int i = 0; i < 20; i++)
+	{
+		XMLElement* root = docs[i].first_node();
+		EXPECT_EQ(root->document(), &docs[i]);
+		EXPECT_EQ(atoi(root->first_attribute("n")->value()), i);
+		EXPECT_EQ(root->child_count(), 2u);
+	}
+
+	//moved document keeps its settings, moved-from document is empty and reusable
+	rapidxml::xml_id_index<> index;
+	index.add_attribute_name("id");
+	rapidxml::xml_document<> source(nullptr, 0);
+	source.set_allocator(malloc, free);
+	source.set_id_index(&index);
+	std::string text = "<Root><Item id=\"a\"/><Item id=\"b\"/></Root>";
+	source.parse<rapidxml::parse_id_index | rapidxml::parse_document_order>(&text[0]);
+	std::size_t generation = source.generation();
+	rapidxml::xml_document<> moved(std::move(source));
+	EXPECT_NE(moved.memory_resource(), source.memory_resource());
+	EXPECT_EQ(moved.id_index(), &index);
+	EXPECT_EQ(moved.element_by_id("b")->document(), &moved);
+#ifdef RAPIDXML_DOCUMENT_ORDER
+	EXPECT_TRUE(moved.document_order_linked());
+#endif
+	EXPECT_EQ(moved.next_in_document_order(), moved.first_node());
+	EXPECT_EQ(source.first_node(), nullptr);
+	EXPECT_EQ(source.id_index(), nullptr);
+	EXPECT_NE(source.generation(), generation);
+	moved.first_node()->append_node(moved.allocate_node(rapidxml::node_type::node_element, "Added"));
+	std::string again = "<Again/>";
+	source.parse<0>(&again[0]);
+	EXPECT_STREQ(source.first_node()->name(), "Again");
+
+	//move assignment releases previous contents
+	generation = moved.generation();
+	moved = std::move(source);
+	EXPECT_STREQ(moved.first_node()->name(), "Again");
+	EXPECT_GT(moved.generation(), generation);
+	EXPECT_EQ(index.size(), 0u);
+
+	//caller-supplied static memory is taken over with the document
+	char buffer[4096];
+	rapidxml::xml_document<> with_static(buffer, sizeof(buffer));
+	std::string small = "<Small><A/><B/></Small>";
+	with_static.parse<0>(&small[0]);
+	rapidxml::xml_document<> target = std::move(with_static);
+	EXPECT_EQ(with_static.static_memory_size(), 0u);
+	EXPECT_EQ(target.static_memory_size(), sizeof(buffer));
+	with_static.allocate_node(rapidxml::node_type::node_element, "Elsewhere");
+	EXPECT_STREQ(target.first_node()->last_node()->name(), "B");
+
+	//documents with unused embedded static memory are moved too, and both keep their own
+	auto fresh = std::make_unique<rapidxml::xml_document<>>();
+	auto from_fresh = std::make_unique<rapidxml::xml_document<>>(std::move(*fresh));
+	XMLElement* node = from_fresh->allocate_node(rapidxml::node_type::node_element, "Node");
+	EXPECT_GE((char*)node, (char*)from_fresh.get());
+	EXPECT_LT((char*)node, (char*)from_fresh.get() + sizeof(*from_fresh));
+	node = fresh->allocate_node(rapidxml::node_type::node_element, "Node");
+	EXPECT_GE((char*)node, (char*)fresh.get());
+	EXPECT_LT((char*)node, (char*)fresh.get() + sizeof(*fresh));
+
+	//documents which allocated from embedded static memory are copied out of it, and outlive the moved-from document
+	auto parsed = std::make_unique<rapidxml::xml_document<>>();
+	parsed->set_id_index(&index);
+	std::string parsed_text = "<Root><A id=\"x\"/><B>Text</B></Root>";
+	parsed->parse<rapidxml::parse_id_index>(&parsed_text[0]);
+	rapidxml::xml_document<> relocated(std::move(*parsed));
+	parsed.reset();
+	std::fill(parsed_text.begin(), parsed_text.end(), 'x');
+	EXPECT_STREQ(relocated.first_node()->first_node("B")->value(), "Text");
+	EXPECT_EQ(relocated.first_node()->document(), &relocated);
+	EXPECT_EQ(relocated.element_by_id("x"), relocated.first_node()->first_node("A"));
+	EXPECT_EQ(relocated.static_memory_size(), size_t(RAPIDXML_STATIC_POOL_SIZE));
+
+	//and so are documents assigned to
+	rapidxml::xml_document<> assigned;
+	assigned = ParseCopy("<Assigned><C/></Assigned>");
+	EXPECT_STREQ(assigned.first_node()->first_node()->name(), "C");
+	assigned.clear();
+	node = assigned.allocate_node(rapidxml::node_type::node_element, "Node");
+	EXPECT_GE((char*)node, (char*)&assigned);
+	EXPECT_LT((char*)node, (char*)&assigned + sizeof(assigned));
+}
+
+#if defined(__cpp_lib_ranges) && __cpp_lib_ranges >= 201911L
+TEST(BasicTests, Ranges)
+{
+	static_assert(std::ranges::bidirectional_range<rapidxml::child_view<char>>);
+	static_assert(std::ranges::bidirectional_range<rapidxml::attribute_view<char>>);
+	static_assert(std::ranges::forward_range<rapidxml::descendant_view<char>>);
+	static_assert(std::ranges::view<rapidxml::child_view<char>> && std::ranges::borrowed_range<rapidxml::descendant_view<char>>);
+
+	std::string text = "<Root a=\"1\" b=\"2\" a=\"3\"><Item v=\"1\"/><Other/><Item v=\"2\"><Item v=\"3\"/></Item></Root>";
+	rapidxml::xml_document<> doc;
+	doc.parse<0>(&text[0]);
+	XMLElement* root = doc.first_node();
+
+	EXPECT_EQ(std::ranges::distance(rapidxml::children(root)), 3);
+	EXPECT_EQ(std::ranges::distance(rapidxml::children(root, "Item")), 2);
+	EXPECT_STREQ(std::ranges::prev(rapidxml::children(root, "Item").end())->first_attribute("v")->value(), "2");
+	EXPECT_EQ(std::ranges::distance(rapidxml::attributes(root, "a")), 2);
+	EXPECT_STREQ((*std::ranges::rbegin(rapidxml::attributes(root))).value(), "3");
+	EXPECT_EQ(std::ranges::distance(rapidxml::descendants(&doc, "Item")), 3);
+	EXPECT_EQ(std::ranges::distance(rapidxml::descendants(root, rapidxml::node_type::node_element)), 4);
+
+	//composition with standard adaptors
+	std::string values;
+	for (const char* value : rapidxml::descendants(root, "Item")
+		| std::views::transform([](XMLElement& node) { return node.first_attribute("v")->value(); })
+		| std::views::filter([](const char* value) { return value[0] != '2'; }))
+		values += value;
+	EXPECT_EQ(values, "13");
+
+	std::string reversed;
+	for (XMLAttributte& attribute : rapidxml::attributes(root) | std::views::reverse)
+		reversed += attribute.name();
+	EXPECT_EQ(reversed, "aba");
+
+	auto other = std::ranges::find_if(rapidxml::children(root), [](XMLElement& node) { return node.name()[0] == 'O'; });
+	EXPECT_EQ(&*other, root->first_node("Other"));
+}
+#endif
@@ -1,10 +1,31 @@
 #include "RapidXMLSTD.hpp"
 #include "rapidxml_print.hpp"
+#include "rapidxml_query.hpp"
 
 // Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
 // Version 1.17
 // Revision $DateTime: 2023/09/19 23:27:00 $
 
+/**Returns name and value of an element or attribute to its document for reuse, if they were allocated from the document
+* @param doc - The document
+* @param object - The element or attribute*/
+static void FreeStrings(rapidxml::xml_document<char, 0>* doc, rapidxml::xml_base<>* object)
+{
+	doc->free_string(object->name(), object->name_size() + 1);
+	doc->free_string(object->value(), object->value_size() + 1);
+}
+/**Returns names and values of an element, its attributes and descendants to its document for reuse, if they were allocated from the document
+* @param doc - The document
+* @param element - The element*/
+static void FreeElementStrings(rapidxml::xml_document<char, 0>* doc, XMLElement* element)
+{
+	FreeStrings(doc, element);
+	for (XMLAttributte* attribute = element->first_attribute(); attribute; attribute = attribute->next_attribute())
+		FreeStrings(doc, attribute);
+	for (XMLElement* child = element->first_node(); child; child = child->next_sibling())
+		FreeElementStrings(doc, child);
+}
+
 /**Opens a new XML file
 * @param filePath - The path to a file
 * @returns A xml file object*/
@@ -259,15 +280,7 @@ XMLElement* FirstOrDefaultElement(XMLElement* parent, const std::string& element
 		return nullptr;
 	}
 		
-	for (XMLElement* x = parent->first_node(); x != nullptr; x = x->next_sibling())
-	{
-		if (x && std::string(x->name()) == elementName)
-		{
-			return x;
-		}
-	}
-
-	return nullptr;
+	return parent->first_node(elementName.c_str(), elementName.size());
 }
 /**Searches for a named element
 * @param parent - A xml document object
@@ -289,6 +302,35 @@ XMLElement* FirstOrDefaultElementA(XMLDocument* parent, const std::string& eleme
 
 	return parent->first_node(elementName.c_str());
 }
+/**Searches for the first element selected by a path
+* @param parent - A xml element or document object, relative to which the path is evaluated
+* @param path - The path, in the XPath subset supported by rapidxml::xml_query
+* @returns The element, if success*/
+XMLElement* SelectFirstElement(XMLElement* parent, const std::string& path, std::string& error)
+{
+	if (!parent)
+	{
+		error = "Parent cannot be null";
+		return nullptr;
+	}
+
+	if (path.empty())
+	{
+		error = "Path cannot be null";
+		return nullptr;
+	}
+
+	try
+	{
+		rapidxml::xml_query<> query(path.c_str(), path.size());
+		return query.first(parent);
+	}
+	catch (const rapidxml::parse_error& e)
+	{
+		error = e.what();
+		return nullptr;
+	}
+}
 
 XMLAttributte* FirstOrDefaultAttribute(XMLElement* parent, const std::string& attributeName, std::string& error)
 {
@@ -315,13 +357,14 @@ const bool SetAttributeValue(XMLAttributte* attribute, const std::string& attrib
 		return false;
 	}
 
-	XMLDocument* doc = attribute->document();
+	rapidxml::xml_document<char, 0>* doc = attribute->document();
 	if (!doc)
 	{
 		error = "Parent document cannot be null";
 		return false;
 	}
 
+	doc->free_string(attribute->value(), attribute->value_size() + 1);
 	const char* value = doc->allocate_string(attributeValue.c_str());
 	attribute->value(value);
 	return true;
@@ -373,13 +416,14 @@ const bool SetElementValueA(XMLElement* element, const std::string& elementValue
 		return false;
 	}
 
-	XMLDocument* doc = element->document();
+	rapidxml::xml_document<char, 0>* doc = element->document();
 	if (!doc)
 	{
 		error = "Parent document cannot be null";
 		return false;
 	}
 
+	doc->free_string(element->value(), element->value_size() + 1);
 	const char* value = doc->allocate_string(elementValue.c_str());
 	element->value(value);
 	return true;
@@ -445,5 +489,79 @@ const bool AddAttributeToElement(XMLElement* parent, XMLAttributte* child, std::
 	}
 
 	parent->append_attribute(child);
+	return true;
+}
+/**Removes a element from its parent and returns its memory to the document for reuse
+* @param parent - The parent element
+* @param child - The child element
+* @returns True if success*/
+const bool RemoveElementFromElement(XMLElement* parent, XMLElement* child, std::string& error)
+{
+	if (!parent)
+	{
+		error = "Parent cannot be null";
+		return false;
+	}
+
+	if (!child)
+	{
+		error = "Child cannot be null";
+		return false;
+	}
+
+	if (child->parent() != parent)
+	{
+		error = "Child does not belong to parent";
+		return false;
+	}
+
+	rapidxml::xml_document<char, 0>* doc = parent->document();
+	if (!doc)
+	{
+		error = "Parent does not belong to a document";
+		return false;
+	}
+
+	parent->remove_node(child);
+	FreeElementStrings(doc, child);
+	doc->free_node(child);
+
+	return true;
+}
+/**Removes an attribute from a element and returns its memory to the document for reuse
+* @param parent - The parent element
+* @param child - The attribute
+* @returns True if success*/
+const bool RemoveAttributeFromElement(XMLElement* parent, XMLAttributte* child, std::string& error)
+{
+	if (!parent)
+	{
+		error = "Parent cannot be null";
+		return false;
+	}
+
+	if (!child)
+	{
+		error = "Child cannot be null";
+		return false;
+	}
+
+	if (child->parent() != parent)
+	{
+		error = "Attribute does not belong to parent";
+		return false;
+	}
+
+	rapidxml::xml_document<char, 0>* doc = parent->document();
+	if (!doc)
+	{
+		error = "Parent does not belong to a document";
+		return false;
+	}
+
+	parent->remove_attribute(child);
+	FreeStrings(doc, child);
+	doc->free_attribute(child);
+
 	return true;
 }
\ No newline at end of file
@@ -38,13 +38,19 @@ extern "C"
 	* @param error - An error message
 	* @returns The element, if success*/
 	DLL_EX XMLElement* FirstOrDefaultElementA(XMLDocument* parent, const std::string& elementName, std::string& error);
+	/**Searches for the first element selected by a path, such as "Root/Items/Item[@id='5']" or "//Item[2]"
+	* @param parent - A xml element or document object, relative to which the path is evaluated
+	* @param path - The path, in the XPath subset supported by rapidxml::xml_query
+	* @param error - An error message
+	* @returns The element, if success*/
+	DLL_EX XMLElement* SelectFirstElement(XMLElement* parent, const std::string& path, std::string& error);
 	/**Searches for a named attribute
 	* @param parent - A xml document object
 	* @param attributeName - The name of the attribute
 	* @param error - An error message
 	* @returns The attribute, if success*/
 	DLL_EX XMLAttributte* FirstOrDefaultAttribute(XMLElement* parent, const std::string& attributeName, std::string& error);
-	/**Sets the value of an attribute
+	/**Sets the value of an attribute, returning its previous value to the document for reuse if it was allocated from the document
 	* @param attribute - The attribute
 	* @param attributeValue - The value of the attribute
 	* @param error - An error message
@@ -63,7 +69,7 @@ extern "C"
 	* @param error - An error message
 	* @returns True if success*/
 	DLL_EX const bool SetElementValue(XMLElement* parent, XMLElement* child, std::string& error);
-	/**Sets the value of an attribute
+	/**Sets the value of an element, returning its previous value to the document for reuse if it was allocated from the document
 	* @param element - The element
 	* @param elementValue - The element value
 	* @param error - An error message
@@ -138,6 +144,18 @@ extern "C"
 	* @param error - An error message
 	* @returns True if success*/
 	DLL_EX const bool AddAttributeToElement(XMLElement* parent, XMLAttributte* child, std::string& error);
+	/**Removes a element from its parent and returns its memory, including its children, attributes, names and values, to the document for reuse
+	* @param parent - The parent element. It must belong to a document, otherwise nothing is removed
+	* @param child - The child element. It is no longer valid after the call
+	* @param error - An error message
+	* @returns True if success*/
+	DLL_EX const bool RemoveElementFromElement(XMLElement* parent, XMLElement* child, std::string& error);
+	/**Removes an attribute from a element and returns its memory, including its name and value, to the document for reuse
+	* @param parent - The parent element. It must belong to a document, otherwise nothing is removed
+	* @param child - The attribute. It is no longer valid after the call
+	* @param error - An error message
+	* @returns True if success*/
+	DLL_EX const bool RemoveAttributeFromElement(XMLElement* parent, XMLAttributte* child, std::string& error);
 	/**Creates an attribute
 	* @param doc - A xml document object
 	* @param attributeName - The name of the attribute
@@ -176,13 +194,19 @@ XMLElement* FirstOrDefaultElement(XMLElement* parent, const std::string& element
 * @param error - An error message
 * @returns The element, if success*/
 XMLElement* FirstOrDefaultElementA(XMLDocument* parent, const std::string& elementName, std::string& error);
+/**Searches for the first element selected by a path, such as "Root/Items/Item[@id='5']" or "//Item[2]"
+* @param parent - A xml element or document object, relative to which the path is evaluated
+* @param path - The path, in the XPath subset supported by rapidxml::xml_query
+* @param error - An error message
+* @returns The element, if success*/
+XMLElement* SelectFirstElement(XMLElement* parent, const std::string& path, std::string& error);
 /**Searches for a named attribute
 * @param parent - A xml document object
 * @param attributeName - The name of the attribute
 * @param error - An error message
 * @returns The attribute, if success*/
 XMLAttributte* FirstOrDefaultAttribute(XMLElement* parent, const std::string& attributeName, std::string& error);
-/**Sets the value of an attribute
+/**Sets the value of an attribute, returning its previous value to the document for reuse if it was allocated from the document
 * @param attribute - The attribute
 * @param attributeValue - The value of the attribute
 * @param error - An error message
@@ -201,7 +225,7 @@ const bool SetAttributeValueA(XMLElement* element, const std::string& attributeN
 * @param error - An error message
 * @returns True if success*/
 const bool SetElementValue(XMLElement* parent, XMLElement* child, std::string& error);
-/**Sets the value of an attribute
+/**Sets the value of an element, returning its previous value to the document for reuse if it was allocated from the document
 * @param element - The element
 * @param elementValue - The element value
 * @param error - An error message
@@ -276,6 +300,18 @@ const bool AddElementToElement(XMLElement* parent, XMLElement* child, std::strin
 * @param error - An error message
 * @returns True if success*/
 const bool AddAttributeToElement(XMLElement* parent, XMLAttributte* child, std::string& error);
+/**Removes a element from its parent and returns its memory, including its children, attributes, names and values, to the document for reuse
+* @param parent - The parent element. It must belong to a document, otherwise nothing is removed
+* @param child - The child element. It is no longer valid after the call
+* @param error - An error message
+* @returns True if success*/
+const bool RemoveElementFromElement(XMLElement* parent, XMLElement* child, std::string& error);
+/**Removes an attribute from a element and returns its memory, including its name and value, to the document for reuse
+* @param parent - The parent element. It must belong to a document, otherwise nothing is removed
+* @param child - The attribute. It is no longer valid after the call
+* @param error - An error message
+* @returns True if success*/
+const bool RemoveAttributeFromElement(XMLElement* parent, XMLAttributte* child, std::string& error);
 /**Creates an attribute
 * @param doc - A xml document object
 * @param attributeName - The name of the attribute
@@ -12,8 +12,13 @@
     #include <cstdlib>      // For std::size_t
     #include <cassert>      // For assert
     #include <new>          // For placement new
+    #include <cstdint>      // For std::uint32_t
 #endif
 
+// Memory pools and indexes take std::pmr::memory_resource, which is part of their interface, 
+// so this header is included even if standard library is disabled
+#include <memory_resource>  // For std::pmr::memory_resource
+
 // On MSVC, disable "conditional expression is constant" warning (level 4). 
 // This warning is almost impossible to avoid with certain types of templated code
 #ifdef _MSC_VER
@@ -111,9 +116,11 @@ namespace rapidxml
 // Pool sizes
 
 #ifndef RAPIDXML_STATIC_POOL_SIZE
-    // Size of static memory block of memory_pool.
+    // Default size of static memory block embedded in xml_document.
     // Define RAPIDXML_STATIC_POOL_SIZE before including rapidxml.hpp if you want to override the default value.
     // No dynamic memory allocations are performed by memory_pool until static memory is exhausted.
+    // Individual documents can embed other amounts, see xml_document; xml_document<Ch, 0> embeds none, so that it is small.
+    // Standalone memory_pool does not embed static memory, it uses a caller-supplied buffer, if any.
     #define RAPIDXML_STATIC_POOL_SIZE (64 * 1024)
 #endif
 
@@ -124,6 +131,46 @@ namespace rapidxml
     #define RAPIDXML_DYNAMIC_POOL_SIZE (64 * 1024)
 #endif
 
+#ifndef RAPIDXML_LAYOUT_BLOCK_SIZE
+    // Size of block of nodes used by blocked layout of xml_document::relayout().
+    // Define RAPIDXML_LAYOUT_BLOCK_SIZE before including rapidxml.hpp if you want to override the default value.
+    // Each block holds top levels of a subtree, so it should match unit of memory most expensive to miss, usually a page.
+    #define RAPIDXML_LAYOUT_BLOCK_SIZE (4 * 1024)
+#endif
+
+#ifndef RAPIDXML_CHILD_INDEX_THRESHOLD
+    // Number of child nodes at which parser builds child index of an element, if rapidxml::parse_index_wide_elements flag is specified.
+    // Define RAPIDXML_CHILD_INDEX_THRESHOLD before including rapidxml.hpp if you want to override the default value.
+    #define RAPIDXML_CHILD_INDEX_THRESHOLD 64
+#endif
+
+// Define RAPIDXML_NODE_COUNTS before including rapidxml.hpp to have each node keep numbers of its children and attributes,
+// so that xml_node::child_count(), xml_node::attribute_count() and xml_node::nth_child() take constant time.
+// This makes every node two words larger, so by default the counts are not kept, and these functions walk children or attributes instead.
+
+// Define RAPIDXML_DOCUMENT_ORDER before including rapidxml.hpp to have each node keep a link to the next node in document order,
+// which is set by the parser if rapidxml::parse_document_order flag is specified, so that descendant iterators advance in constant time.
+// This makes every node one word larger, so by default the links are not kept, and xml_node::next_in_document_order() walks up the tree instead.
+
+// Define RAPIDXML_ATTRIBUTE_ARRAYS before including rapidxml.hpp to have each node remember how many of its attributes are stored as contiguous array,
+// so that xml_node::attribute() takes constant time, and named attribute lookups scan the array instead of following links.
+// This makes every node one word larger, so by default it is not remembered; rapidxml::parse_contiguous_attributes still places attributes
+// next to each other in memory, but they are reached through links.
+
+// Define RAPIDXML_CHILD_INDEX before including rapidxml.hpp to have each node keep a pointer to hash index of its children,
+// which is built by memory_pool::index_children() or by the parser if rapidxml::parse_index_wide_elements flag is specified.
+// This makes every node one word larger, so by default children are never indexed, and named lookups walk them instead.
+
+// Define RAPIDXML_NAME_HASHES before including rapidxml.hpp to have each node and attribute keep a hash of its name,
+// which is computed by the parser if rapidxml::parse_name_hashes flag is specified, so that named lookups compare hashes first.
+// Together with symbol IDs, see RAPIDXML_NAME_SYMBOLS, this makes every node and attribute one word larger,
+// so by default hashes are not kept, and named lookups compare names character by character.
+
+// Define RAPIDXML_NAME_SYMBOLS before including rapidxml.hpp to have each node and attribute keep symbol ID of its name,
+// which is assigned by the parser if rapidxml::parse_intern_names flag is specified or if a vocabulary is used, see xml_vocabulary.
+// Together with name hashes, see RAPIDXML_NAME_HASHES, this makes every node and attribute one word larger,
+// so by default symbol IDs are not kept, and xml_base::symbol(), lookups by symbol and interning of names are not available.
+
 #ifndef RAPIDXML_ALIGNMENT
     // Memory allocation alignment.
     // Define RAPIDXML_ALIGNMENT before including rapidxml.hpp if you want to override the default value, which is the size of pointer.
@@ -135,9 +182,14 @@ namespace rapidxml
 namespace rapidxml
 {
     // Forward declarations
+    template<class Ch> class memory_pool;
+    template<class Ch> class xml_base;
     template<class Ch> class xml_node;
     template<class Ch> class xml_attribute;
-    template<class Ch> class xml_document;
+    template<class Ch = char, std::size_t StaticSize = RAPIDXML_STATIC_POOL_SIZE> class xml_document;
+    template<class Ch> class xml_symbol_table;
+    template<class Ch, std::size_t N> class xml_vocabulary;
+    template<class Ch> class xml_id_index;
     
     //! Enumeration listing all node types produced by the parser.
     //! Use xml_node::type() function to query node type.
@@ -247,6 +299,73 @@ namespace rapidxml
     //! See xml_document::parse() function.
     const int parse_normalize_whitespace = 0x800;
 
+    //! Parse flag instructing the parser to store attributes of each element as a contiguous array, allocated in one piece.
+    //! Attributes remain linked as usual, so all attribute functions work unchanged, 
+    //! but following the links visits adjacent memory, and if <code>RAPIDXML_ATTRIBUTE_ARRAYS</code> is defined,
+    //! xml_node::attribute() takes constant time, and named attribute lookups scan the array rather than following links.
+    //! By default, attributes are allocated one by one and are usually, but not necessarily, adjacent.
+    //! This flag does not cause the parser to modify source text.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::parse() function.
+    const int parse_contiguous_attributes = 0x1000;
+
+    //! Parse flag instructing the parser to compute a 32-bit hash of each element and attribute name while scanning it.
+    //! Case-sensitive named lookups, such as xml_node::first_node() or xml_node::first_attribute(), 
+    //! then compare hashes first and compare characters only if hashes are equal.
+    //! By default, hashes are not computed, and all names of the same length are compared character by character.
+    //! This flag has no effect unless <code>RAPIDXML_NAME_HASHES</code> is defined.
+    //! This flag does not cause the parser to modify source text.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::parse() function and xml_base::name_hash().
+    const int parse_name_hashes = 0x2000;
+
+    //! Parse flag instructing the parser to intern each element and attribute name in symbol table of the document,
+    //! and store its symbol ID in the node or attribute.
+    //! Symbol table must be set with xml_document::set_symbol_table() before parsing.
+    //! Nodes and attributes can then be looked up by symbol ID with a single integer comparison, 
+    //! see xml_node::first_node_by_symbol(), and their symbol IDs can be used in switch statements.
+    //! Name hashes are stored as well, as if rapidxml::parse_name_hashes was specified.
+    //! By default, names are not interned.
+    //! This flag requires <code>RAPIDXML_NAME_SYMBOLS</code> to be defined.
+    //! This flag does not cause the parser to modify source text.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::parse() function and xml_base::symbol().
+    const int parse_intern_names = 0x4000;
+
+    //! Parse flag instructing the parser to build child index of each element with at least <code>RAPIDXML_CHILD_INDEX_THRESHOLD</code> child nodes, not counting data nodes,
+    //! as if by memory_pool::index_children(), so that named lookups of its children take constant time.
+    //! By default, no child indexes are built.
+    //! This flag has no effect unless <code>RAPIDXML_CHILD_INDEX</code> is defined.
+    //! This flag does not cause the parser to modify source text.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::parse() function.
+    const int parse_index_wide_elements = 0x8000;
+
+    //! Parse flag instructing the parser to add attributes named in ID index of the document to the index as they are created,
+    //! so that xml_document::element_by_id() finds their nodes.
+    //! ID index must be set with xml_document::set_id_index() before parsing.
+    //! By default, ID index of the document is left empty by parsing.
+    //! This flag does not cause the parser to modify source text.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::parse() function.
+    const int parse_id_index = 0x10000;
+
+    //! Parse flag instructing the parser to link each node to the next node in document order,
+    //! so that xml_node::next_in_document_order() and descendant iterators advance in constant time, without walking up the tree.
+    //! Links remain valid until the document is modified, see xml_document::document_order_linked(); 
+    //! they can be restored afterwards with xml_document::link_document_order().
+    //! This flag has no effect unless <code>RAPIDXML_DOCUMENT_ORDER</code> is defined.
+    //! This flag does not cause the parser to modify source text.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::parse() function.
+    const int parse_document_order = 0x20000;
+
     // Compound flags
     
     //! Parse flags which represent default behaviour of the parser. 
@@ -280,6 +399,37 @@ namespace rapidxml
     //! See xml_document::parse() function.
     const int parse_full = parse_declaration_node | parse_comment_nodes | parse_doctype_node | parse_pi_nodes | parse_validate_closing_tags;
 
+    ///////////////////////////////////////////////////////////////////////
+    // Layout flags
+
+    //! Layout flag placing nodes in memory in document order (depth-first preorder), each node followed by its first child.
+    //! This is the layout produced by xml_document::compact(). It favours full traversals of the document.
+    //! <br><br>
+    //! See xml_document::relayout() function.
+    const int layout_depth_first = 0;
+
+    //! Layout flag placing nodes in memory level by level (breadth-first), so that all children of a node are next to each other,
+    //! and children of consecutive siblings follow one another.
+    //! It favours lookups which scan siblings and descend into few of them, for example following known paths.
+    //! <br><br>
+    //! See xml_document::relayout() function.
+    const int layout_breadth_first = 0x1;
+
+    //! Layout flag placing nodes in memory in blocks of <code>RAPIDXML_LAYOUT_BLOCK_SIZE</code> bytes, each holding top levels of a subtree breadth-first,
+    //! with subtrees which did not fit starting blocks of their own, in document order.
+    //! Lookups descending from root to a deep node then touch one block per few levels, rather than one per level.
+    //! <br><br>
+    //! See xml_document::relayout() function.
+    const int layout_blocked = 0x2;
+
+    //! Layout flag which, combined with rapidxml::layout_depth_first, places all children of a node next to each other, 
+    //! like an inline array, before the subtree of its first child.
+    //! Breadth-first and blocked layouts always place children next to each other, so this flag has no effect on them.
+    //! Can be combined with other flags by use of | operator.
+    //! <br><br>
+    //! See xml_document::relayout() function.
+    const int layout_inline_children = 0x4;
+
     ///////////////////////////////////////////////////////////////////////
     // Internals
 
@@ -336,6 +486,182 @@ namespace rapidxml
             }
             return true;
         }
+
+        // Add character to hash of name (32-bit FNV-1a)
+        template<class Ch>
+        constexpr std::uint32_t hash_step(std::uint32_t hash, Ch ch)
+        {
+            return (hash ^ static_cast<std::uint32_t>(ch)) * 16777619u;
+        }
+
+        // Initial value of hash of name
+        constexpr std::uint32_t hash_basis = 2166136261u;
+
+        // Finish hash of name; result is never 0, which marks names without hash
+        constexpr std::uint32_t hash_final(std::uint32_t hash)
+        {
+            return hash ? hash : 1;
+        }
+
+        // Compute hash of name
+        template<class Ch>
+        constexpr std::uint32_t hash(const Ch *p, std::size_t size)
+        {
+            std::uint32_t result = hash_basis;
+            for (const Ch *end = p + size; p < end; ++p)
+                result = hash_step(result, *p);
+            return hash_final(result);
+        }
+
+        // Hash index of children of a node, see memory_pool::index_children().
+        // Names are mapped to first and last child with the name, and each child to the next child with the same name.
+        // Both tables use open addressing with linear probing; table sizes are powers of 2.
+        template<class Ch>
+        struct child_index
+        {
+            struct name_slot
+            {
+                xml_node<Ch> *first;        // First child with the name, or 0 if slot is empty
+                xml_node<Ch> *last;         // Last child with the name
+                std::uint32_t hash;         // Hash of the name
+            };
+
+            struct node_slot
+            {
+                const xml_node<Ch> *node;   // Child, or 0 if slot is empty
+                xml_node<Ch> *next;         // Next child with the same name
+            };
+
+            // Hash of node address
+            static std::size_t node_hash(const xml_node<Ch> *node)
+            {
+                return static_cast<std::size_t>((reinterpret_cast<std::size_t>(node) / sizeof(void *)) * 2654435761u);
+            }
+
+            // Find slot of a name, or empty slot where it belongs
+            name_slot *find(const Ch *name, std::size_t size, std::uint32_t hash) const
+            {
+                std::size_t slot = hash & name_mask;
+                while (names[slot].first && !(names[slot].hash == hash && compare(names[slot].first->name(), names[slot].first->name_size(), name, size, true)))
+                    slot = (slot + 1) & name_mask;
+                return &names[slot];
+            }
+
+            // Find next child with the same name as given child
+            xml_node<Ch> *next(const xml_node<Ch> *node) const
+            {
+                if (!nodes)
+                    return 0;
+                for (std::size_t slot = node_hash(node) & node_mask; nodes[slot].node; slot = (slot + 1) & node_mask)
+                    if (nodes[slot].node == node)
+                        return nodes[slot].next;
+                return 0;
+            }
+
+            name_slot *names;               // Table of names
+            std::size_t name_mask;          // Number of name slots minus 1
+            std::size_t name_count;         // Number of distinct names
+            node_slot *nodes;               // Table of children followed by a child with the same name, or 0 if none
+            std::size_t node_mask;          // Number of node slots minus 1
+            xml_node<Ch> **children;        // Children in document order, for positional access
+            std::size_t child_count;        // Number of children
+            std::size_t child_capacity;     // Number of children array can hold
+            bool valid;                     // Whether index is up to date; discarded index is kept so that its memory is reused when node is indexed again
+        };
+
+        // Numbers of children and attributes of a node; kept only if RAPIDXML_NODE_COUNTS is defined, otherwise empty
+        struct node_counts
+        {
+#ifdef RAPIDXML_NODE_COUNTS
+            std::size_t children;           // Number of child nodes
+            std::size_t attributes;         // Number of attributes
+
+            node_counts()
+                : children(0)
+                , attributes(0)
+            {
+            }
+
+            void add_child() { ++children; }
+            void remove_child() { --children; }
+            void clear_children() { children = 0; }
+            void add_attribute() { ++attributes; }
+            void remove_attribute() { --attributes; }
+            void clear_attributes() { attributes = 0; }
+#else
+            void add_child() {}
+            void remove_child() {}
+            void clear_children() {}
+            void add_attribute() {}
+            void remove_attribute() {}
+            void clear_attributes() {}
+#endif
+        };
+
+        // Flag added by xml_document::parse() overload taking a vocabulary, instructing the parser to classify names with it
+        const int parse_vocabulary = 0x40000000;
+
+        // Flags instructing the parser to hash names while scanning them; hashes are only stored if RAPIDXML_NAME_HASHES is defined
+#ifdef RAPIDXML_NAME_HASHES
+        const int parse_hashing = parse_name_hashes | parse_intern_names | parse_vocabulary;
+#else
+        const int parse_hashing = parse_intern_names | parse_vocabulary;
+#endif
+
+        // Adapts user-defined allocation functions of memory_pool::set_allocator() to std::pmr::memory_resource.
+        // Either function may be 0, in which case global new[] or delete[] is used for it.
+        class function_resource: public std::pmr::memory_resource
+        {
+
+        public:
+
+            typedef void *(alloc_func)(std::size_t);
+            typedef void (free_func)(void *);
+
+            function_resource()
+                : m_alloc_func(0)
+                , m_free_func(0)
+            {
+            }
+
+            void set(alloc_func *af, free_func *ff)
+            {
+                m_alloc_func = af;
+                m_free_func = ff;
+            }
+
+            // Adapters of the same functions are interchangeable, so that pools set up with the same functions can adopt each other's memory
+            bool same_functions(const function_resource &other) const
+            {
+                return other.m_alloc_func == m_alloc_func && other.m_free_func == m_free_func;
+            }
+
+        private:
+
+            virtual void *do_allocate(std::size_t bytes, std::size_t)
+            {
+                if (m_alloc_func)
+                    return m_alloc_func(bytes);
+                return new char[bytes];
+            }
+
+            virtual void do_deallocate(void *p, std::size_t, std::size_t)
+            {
+                if (m_free_func)
+                    m_free_func(p);
+                else
+                    delete[] static_cast<char *>(p);
+            }
+
+            // Adapter cannot tell whether other resource is an adapter too without RTTI, so memory_pool compares adapters with same_functions()
+            virtual bool do_is_equal(const std::pmr::memory_resource &other) const noexcept
+            {
+                return this == &other;
+            }
+
+            alloc_func *m_alloc_func;
+            free_func *m_free_func;
+        };
     }
     //! \endcond
 
@@ -353,18 +679,25 @@ namespace rapidxml
     //! Call allocate_node() or allocate_attribute() functions to obtain new nodes or attributes from the pool. 
     //! You can also call allocate_string() function to allocate strings.
     //! Such strings can then be used as names or values of nodes without worrying about their lifetime.
-    //! Note that there is no <code>free()</code> function -- all allocations are freed at once when clear() function is called, 
+    //! Pool is not thread-safe; to allocate from several threads at once, use concurrent_memory_pool from rapidxml_concurrent.hpp.
+    //! Note that there is no general <code>free()</code> function -- all allocations are freed at once when clear() function is called, 
     //! or when the pool is destroyed.
+    //! The only exception are nodes and attributes, which can be returned to the pool with free_node() and free_attribute() once they are removed from the tree.
+    //! They are kept on free lists, separate for nodes and attributes, and reused by subsequent allocate_node() and allocate_attribute() calls,
+    //! so that documents which are edited continuously do not grow without bound.
     //! <br><br>
     //! It is also possible to create a standalone memory_pool, and use it 
     //! to allocate nodes, whose lifetime will not be tied to any document.
     //! <br><br>
-    //! Pool maintains <code>RAPIDXML_STATIC_POOL_SIZE</code> bytes of statically allocated memory. 
+    //! Pool can be given a caller-supplied block of static memory, either in the constructor or with set_static_memory() function. 
     //! Until static memory is exhausted, no dynamic memory allocations are done.
+    //! Pool does not embed any static memory itself, so it only takes a few pointers of space;
+    //! xml_document embeds <code>RAPIDXML_STATIC_POOL_SIZE</code> bytes of static memory by default and gives them to its pool.
     //! When static memory is exhausted, pool allocates additional blocks of memory of size <code>RAPIDXML_DYNAMIC_POOL_SIZE</code> each,
     //! by using global <code>new[]</code> and <code>delete[]</code> operators. 
-    //! This behaviour can be changed by setting custom allocation routines. 
-    //! Use set_allocator() function to set them.
+    //! This behaviour can be changed by setting a <code>std::pmr::memory_resource</code>, 
+    //! either in the constructor or with set_memory_resource() function, 
+    //! or by setting custom allocation routines with set_allocator() function.
     //! <br><br>
     //! Allocations for nodes, attributes and strings are aligned at <code>RAPIDXML_ALIGNMENT</code> bytes.
     //! This value defaults to the size of pointer on target architecture.
@@ -379,6 +712,8 @@ namespace rapidxml
     template<class Ch = char>
     class memory_pool
     {
+
+        friend class xml_document<Ch, 0>;
         
     public:
 
@@ -387,14 +722,69 @@ namespace rapidxml
         typedef void (free_func)(void *);              // Type of user-defined function used to free memory
         //! \endcond
         
-        //! Constructs empty pool with default allocator functions.
+        //! Constructs empty pool with default allocator functions and no static memory.
         memory_pool()
-            : m_alloc_func(0)
-            , m_free_func(0)
+            : m_static_memory(0)
+            , m_static_size(0)
+            , m_resource(0)
+            , m_segregated(false)
+        {
+            init();
+        }
+
+        //! Constructs empty pool which obtains its dynamic blocks from a memory resource.
+        //! The resource must outlive the pool, or at least the last call to clear().
+        //! \param resource Memory resource to allocate dynamic blocks from, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        explicit memory_pool(std::pmr::memory_resource *resource)
+            : m_static_memory(0)
+            , m_static_size(0)
+            , m_resource(resource)
+            , m_segregated(false)
+        {
+            init();
+        }
+
+        //! Constructs empty pool which serves allocations from caller-supplied static memory until it is exhausted.
+        //! The memory is not owned by the pool, and must outlive it.
+        //! \param buffer Static memory to use, or 0 if none.
+        //! \param size Size of static memory, in bytes.
+        //! \param resource Memory resource to allocate dynamic blocks from, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        memory_pool(char *buffer, std::size_t size, std::pmr::memory_resource *resource = 0)
+            : m_static_memory(buffer)
+            , m_static_size(buffer ? size : 0)
+            , m_resource(resource)
+            , m_segregated(false)
         {
             init();
         }
 
+        //! Constructs pool which takes over all memory of another pool, together with nodes, attributes and strings allocated from it.
+        //! Nothing is copied, so pointers to them remain valid.
+        //! Static memory of the other pool, if any, is taken over as well, and must outlive this pool.
+        //! The other pool is left empty, without static memory, but with its memory resource.
+        //! \param other Pool to move from.
+        memory_pool(memory_pool &&other)
+            : m_static_memory(0)
+            , m_static_size(0)
+            , m_resource(0)
+            , m_segregated(false)
+        {
+            take(other);
+        }
+
+        //! Frees all memory of the pool, as clear() does, and takes over all memory of another pool, as the move constructor does.
+        //! \param other Pool to move from.
+        //! \return Reference to this pool.
+        memory_pool &operator =(memory_pool &&other)
+        {
+            if (this != &other)
+            {
+                clear();
+                take(other);
+            }
+            return *this;
+        }
+
         //! Destroys pool and frees all the memory. 
         //! This causes memory occupied by nodes allocated by the pool to be freed.
         //! Nodes allocated from the pool are no longer valid.
@@ -417,7 +807,7 @@ namespace rapidxml
                                     const Ch *name = 0, const Ch *value = 0, 
                                     std::size_t name_size = 0, std::size_t value_size = 0)
         {
-            void *memory = allocate_aligned(sizeof(xml_node<Ch>));
+            void *memory = m_free_nodes ? pop_free(m_free_nodes) : allocate_aligned(sizeof(xml_node<Ch>), node_arena);
             xml_node<Ch> *node = new(memory) xml_node<Ch>(type);
             if (name)
             {
@@ -448,7 +838,7 @@ namespace rapidxml
         xml_attribute<Ch> *allocate_attribute(const Ch *name = 0, const Ch *value = 0, 
                                               std::size_t name_size = 0, std::size_t value_size = 0)
         {
-            void *memory = allocate_aligned(sizeof(xml_attribute<Ch>));
+            void *memory = m_free_attributes ? pop_free(m_free_attributes) : allocate_aligned(sizeof(xml_attribute<Ch>), attribute_arena);
             xml_attribute<Ch> *attribute = new(memory) xml_attribute<Ch>;
             if (name)
             {
@@ -479,7 +869,7 @@ namespace rapidxml
             assert(source || size);     // Either source or size (or both) must be specified
             if (size == 0)
                 size = internal::measure(source) + 1;
-            Ch *result = static_cast<Ch *>(allocate_aligned(size * sizeof(Ch)));
+            Ch *result = static_cast<Ch *>(allocate_string_memory(aligned_size(size * sizeof(Ch))));
             if (source)
                 for (std::size_t i = 0; i < size; ++i)
                     result[i] = source[i];
@@ -509,34 +899,246 @@ namespace rapidxml
 
             // Clone name and value
             result->name(source->name(), source->name_size());
+            result->name_hash(source->name_hash());
+            result->copy_symbol(source);
             result->value(source->value(), source->value_size());
 
             // Clone child nodes and attributes
             for (xml_node<Ch> *child = source->first_node(); child; child = child->next_sibling())
                 result->append_node(clone_node(child));
             for (xml_attribute<Ch> *attr = source->first_attribute(); attr; attr = attr->next_attribute())
-                result->append_attribute(allocate_attribute(attr->name(), attr->value(), attr->name_size(), attr->value_size()));
+            {
+                xml_attribute<Ch> *copy = allocate_attribute(attr->name(), attr->value(), attr->name_size(), attr->value_size());
+                copy->name_hash(attr->name_hash());
+                copy->copy_symbol(attr);
+                result->append_attribute(copy);
+            }
 
             return result;
         }
 
+        //! Clones an xml_node with its attributes and descendants, copying their names and values as well,
+        //! so that the clone does not refer to any memory outside this pool.
+        //! Source may belong to any document or pool, which can be destroyed once the clone is made.
+        //! The subtree is measured first, and then copied into a single allocation from this pool,
+        //! with nodes in document order followed by attributes and strings, so that the clone is contiguous.
+        //! Both passes are iterative, so the subtree can be of any depth.
+        //! <br><br>
+        //! Name hashes are copied, see xml_base::name_hash(); child indexes are not.
+        //! Symbol IDs, see xml_base::symbol(), are only meaningful within the symbol table or vocabulary they come from,
+        //! so they are copied only if source belongs to the document owning this pool, or to a document using given symbol table.
+        //! Otherwise names which have a symbol ID are interned in given symbol table, or have their symbol ID cleared if there is none.
+        //! xml_document::deep_clone() passes symbol table of the document.
+        //! \param source Node to clone; it must not be a document.
+        //! \param symbols Symbol table to intern names in, or 0 if none.
+        //! \return Pointer to cloned node, which has no parent. This pointer will never be NULL.
+        xml_node<Ch> *deep_clone(const xml_node<Ch> *source, xml_symbol_table<Ch> *symbols = 0)
+        {
+            assert(source && source->type() != node_type::node_document);
+
+            // Measure the subtree
+            std::size_t sizes[arena_count] = { aligned_size(sizeof(xml_node<Ch>)), 0, 0 };
+            measure_data(sizes, source);
+            measure_attributes(sizes, source);
+            measure_children(sizes, source);
+
+            // Allocate memory for the whole clone at once, and split it into regions for nodes, attributes and strings
+            char *memory = static_cast<char *>(allocate_aligned(sizes[node_arena] + sizes[attribute_arena] + sizes[string_arena], node_arena));
+            char *regions[arena_count];
+            regions[node_arena] = memory;
+            regions[attribute_arena] = regions[node_arena] + sizes[node_arena];
+            regions[string_arena] = regions[attribute_arena] + sizes[attribute_arena];
+
+            // Copy the subtree
+            xml_node<Ch> *clone = new(regions[node_arena]) xml_node<Ch>(source->type());
+            regions[node_arena] += aligned_size(sizeof(xml_node<Ch>));
+            copy_data(regions, clone, source);
+            copy_attributes(regions, clone, source);
+            copy_children(regions, clone, source);
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+            // Symbol IDs from another symbol table or vocabulary are interned again, or cleared
+            const xml_document<Ch, 0> *document = source->document();
+            if (static_cast<const memory_pool<Ch> *>(document) != this && !(symbols && document && document->symbol_table() == symbols))
+                reintern_symbols(clone, symbols);
+#else
+            (void)symbols;
+#endif
+            return clone;
+        }
+
+        //! Returns a node, together with all its child nodes and attributes, to the pool for reuse.
+        //! Node must have been allocated from this pool and must not have a parent; use xml_node::remove_node() to detach it first.
+        //! Names and values are not freed, they remain allocated until clear() is called.
+        //! Subtree is released iteratively, so it can be of any depth.
+        //! After the call, the node and all its descendants and attributes are no longer valid.
+        //! \param node Node to free.
+        void free_node(xml_node<Ch> *node)
+        {
+            assert(node && !node->parent() && node->type() != node_type::node_document);
+
+            // Nodes waiting to be freed are chained through their next sibling pointers,
+            // so that children of each freed node can be spliced in front of the chain in constant time
+            node->m_next_sibling = 0;
+            while (node)
+            {
+                xml_node<Ch> *next = node->m_next_sibling;
+                if (node->m_first_node)
+                {
+                    node->m_last_node->m_next_sibling = next;
+                    next = node->m_first_node;
+                }
+                for (xml_attribute<Ch> *attribute = node->m_first_attribute; attribute; )
+                {
+                    xml_attribute<Ch> *next_attribute = attribute->m_next_attribute;
+                    push_free(m_free_attributes, attribute);
+                    attribute = next_attribute;
+                }
+                push_free(m_free_nodes, node);
+                node = next;
+            }
+        }
+
+        //! Returns an attribute to the pool for reuse.
+        //! Attribute must have been allocated from this pool and must not have a parent; use xml_node::remove_attribute() to detach it first.
+        //! Name and value are not freed, they remain allocated until clear() is called.
+        //! After the call, the attribute is no longer valid.
+        //! \param attribute Attribute to free.
+        void free_attribute(xml_attribute<Ch> *attribute)
+        {
+            assert(attribute && !attribute->parent());
+            push_free(m_free_attributes, attribute);
+        }
+
+        //! Returns a string to the pool for reuse by later calls to allocate_string().
+        //! Freed strings are kept in lists by size, and reused for strings of up to the same size,
+        //! so that replacing names and values over and over again does not make the pool grow.
+        //! To make that possible, allocate_string() rounds strings of up to <code>64 * sizeof(void *)</code> bytes, with default alignment,
+        //! up to a power of two; longer strings are neither rounded nor recycled.
+        //! <br><br>
+        //! Strings which were not allocated from this pool, such as names and values pointing into parsed text, are ignored,
+        //! so that previous name or value of a node can be passed here without checking where it came from.
+        //! Strings allocated from this pool must have been allocated by allocate_string() as a whole, 
+        //! and must not be used anywhere else, such as in name or value of another node.
+        //! This takes time proportional to the number of blocks of the pool.
+        //! After the call, the string is no longer valid.
+        //! \param string String to free.
+        //! \param size Number of characters the string was allocated with, including terminator, if any.
+        void free_string(Ch *string, std::size_t size)
+        {
+            assert(string && size > 0);
+            char *memory = reinterpret_cast<char *>(string);
+            if (memory != align(memory) || !owns(memory))
+                return;
+            std::size_t size_class = string_class(aligned_size(size * sizeof(Ch)));
+            if (size_class < string_classes)
+                push_free(m_free_strings[size_class], memory);
+        }
+
+        //! Takes ownership of all memory of another pool, together with all nodes, attributes and strings allocated from it,
+        //! which then live until this pool is cleared or destroyed, regardless of what happens to the other pool.
+        //! This takes time proportional to the number of blocks of the other pool, and does not copy or touch any node.
+        //! Once a document adopts memory of another document, subtrees of the other document can be moved to it in constant time,
+        //! by removing them from their parent with xml_node::remove_node() and appending them to a node of this document,
+        //! and the other document can be destroyed afterwards.
+        //! <br><br>
+        //! Names and values which do not point to memory of the pool are not adopted.
+        //! In particular, names and values of parsed nodes point into the parsed text, unless parsing copied them;
+        //! parse text copied into the pool with allocate_string() to make them part of the pool.
+        //! <br><br>
+        //! Both pools must allocate their dynamic blocks from equal memory resources, see set_memory_resource(),
+        //! or from the same allocation functions, see set_allocator(), or both use global <code>new[]</code> and <code>delete[]</code>.
+        //! Static memory is not owned by the pool, so it cannot be adopted; if the other pool allocated anything from its static memory,
+        //! rapidxml::parse_error is thrown, or rapidxml::parse_error_handler() is called if exceptions are disabled.
+        //! xml_document::adopt() copies the tree of the other document out of its static memory instead.
+        //! Nodes and attributes on free list of the other pool are not reused.
+        //! The other pool is left empty, as if cleared.
+        //! <br><br>
+        //! Symbol IDs are not reconciled: nodes moved from the other document keep IDs assigned by its symbol table or vocabulary,
+        //! which are meaningful in this document only if both documents use the same one.
+        //! Otherwise use deep_clone(), which interns names of the copy again.
+        //! \param other Pool whose memory to adopt.
+        void adopt(memory_pool &other)
+        {
+            assert(&other != this);
+            assert(same_allocation(other));
+            if (other.static_memory_used())
+                RAPIDXML_PARSE_ERROR("cannot adopt static memory", 0);
+            for (int kind = 0; kind < arena_count; ++kind)
+            {
+                arena &source = other.m_arenas[kind];
+                if (source.begin == other.arena_bottom(kind))
+                    continue;
+
+                // Find the lowest block of the other chain
+                header *lowest = other.lowest_block(kind);
+
+                arena &target = m_arenas[kind];
+                if (target.begin == arena_bottom(kind))
+                {
+                    // No dynamic block yet, so the other chain is put on top, and its current block continues to serve allocations
+                    lowest->previous_begin = target.begin;
+                    target = source;
+                }
+                else
+                {
+                    // Insert the other chain below current block
+                    header *current = reinterpret_cast<header *>(align(target.begin));
+                    lowest->previous_begin = current->previous_begin;
+                    current->previous_begin = source.begin;
+                }
+            }
+            other.init();
+        }
+
         //! Clears the pool. 
         //! This causes memory occupied by nodes allocated by the pool to be freed.
         //! Any nodes or strings allocated from the pool will no longer be valid.
         void clear()
         {
-            while (m_begin != m_static_memory)
-            {
-                char *previous_begin = reinterpret_cast<header *>(align(m_begin))->previous_begin;
-                if (m_free_func)
-                    m_free_func(m_begin);
-                else
-                    delete[] m_begin;
-                m_begin = previous_begin;
-            }
+            for (int kind = 0; kind < arena_count; ++kind)
+                free_blocks(m_arenas[kind].begin, arena_bottom(kind));
+            init();
+        }
+
+        //! Sets or resets the static memory of the pool.
+        //! This can only be called when no memory is allocated from the pool yet, otherwise results are undefined.
+        //! The memory is not owned by the pool, and must outlive it.
+        //! \param buffer Static memory to use, or 0 to use none.
+        //! \param size Size of static memory, in bytes.
+        void set_static_memory(char *buffer, std::size_t size)
+        {
+            assert(unused());    // Verify that no memory is allocated yet
+            m_static_memory = buffer;
+            m_static_size = buffer ? size : 0;
             init();
         }
 
+        //! Gets size of static memory of the pool.
+        //! \return Size of static memory, in bytes, or 0 if pool has none.
+        std::size_t static_memory_size() const
+        {
+            return m_static_size;
+        }
+
+        //! Sets or resets the memory resource used to allocate dynamic blocks of the pool.
+        //! This can only be called when no memory is allocated from the pool yet, otherwise results are undefined.
+        //! Resource is not owned by the pool, and must outlive it, or at least the last call to clear().
+        //! This replaces any allocation functions set with set_allocator().
+        //! \param resource Memory resource, or 0 to restore global <code>new[]</code> and <code>delete[]</code>.
+        void set_memory_resource(std::pmr::memory_resource *resource)
+        {
+            assert(unused());    // Verify that no memory is allocated yet
+            m_resource = resource;
+        }
+
+        //! Gets memory resource used to allocate dynamic blocks of the pool.
+        //! \return Pointer to memory resource, or 0 if global <code>new[]</code> and <code>delete[]</code> are used.
+        std::pmr::memory_resource *memory_resource() const
+        {
+            return m_resource;
+        }
+
         //! Sets or resets the user-defined memory allocation functions for the pool.
         //! This can only be called when no memory is allocated from the pool yet, otherwise results are undefined.
         //! Allocation function must not return invalid pointer on failure. It should either throw,
@@ -548,95 +1150,1098 @@ namespace rapidxml
         //! <br>void *allocate(std::size_t size);
         //! <br>void free(void *pointer);
         //! </code><br>
+        //! <br><br>
+        //! The functions are adapted to a <code>std::pmr::memory_resource</code> owned by the pool, 
+        //! which replaces any resource set with set_memory_resource().
         //! \param af Allocation function, or 0 to restore default function
         //! \param ff Free function, or 0 to restore default function
         void set_allocator(alloc_func *af, free_func *ff)
         {
-            assert(m_begin == m_static_memory && m_ptr == align(m_begin));    // Verify that no memory is allocated yet
-            m_alloc_func = af;
-            m_free_func = ff;
+            assert(unused());    // Verify that no memory is allocated yet
+            m_function_resource.set(af, ff);
+            m_resource = (af || ff) ? &m_function_resource : 0;
         }
 
-    private:
-
-        struct header
+        //! Builds hash index of children of a node, so that named lookups of its children take constant time.
+        //! It is meant for wide nodes, with hundreds or more children, whose children are repeatedly looked up by name:
+        //! xml_node::first_node() and xml_node::last_node() with a name, and xml_node::next_sibling() with the name of the sibling it is called on,
+        //! no longer walk the children when the comparison is case-sensitive.
+        //! Index also holds an array of pointers to the children, so that xml_node::nth_child() takes constant time.
+        //! Index is allocated from the pool, away from nodes like strings are, and takes about 60 bytes per child.
+        //! <br><br>
+        //! Index is discarded when a child is added to, removed from or renamed in the node, 
+        //! and is not copied by xml_document::compact() or clone_node(); call this function again to rebuild it. 
+        //! Rebuilding reuses memory of the discarded index, allocating more only if the node has grown beyond it.
+        //! This function does nothing unless <code>RAPIDXML_CHILD_INDEX</code> is defined.
+        //! \param node Node to index children of.
+        void index_children(xml_node<Ch> *node)
         {
-            char *previous_begin;
-        };
+#ifdef RAPIDXML_CHILD_INDEX
+            typedef internal::child_index<Ch> index_type;
+            index_type *index = node->m_child_index;
+            if (!index)
+            {
+                index = new(allocate_aligned(sizeof(index_type), string_arena)) index_type;
+                index->names = 0;
+                index->name_mask = 0;
+                index->nodes = 0;
+                index->node_mask = 0;
+                index->children = 0;
+                index->child_capacity = 0;
+            }
+            index->child_count = node->child_count();
+            index->valid = false;
+            index->name_count = 0;
+            if (index->child_count > index->child_capacity)
+            {
+                index->children = static_cast<xml_node<Ch> **>(allocate_aligned(index->child_count * sizeof(xml_node<Ch> *), string_arena));
+                index->child_capacity = index->child_count;
+            }
 
-        void init()
-        {
-            m_begin = m_static_memory;
-            m_ptr = align(m_begin);
-            m_end = m_static_memory + sizeof(m_static_memory);
-        }
-        
-        char *align(char *ptr)
-        {
-            std::size_t alignment = ((RAPIDXML_ALIGNMENT - (std::size_t(ptr) & (RAPIDXML_ALIGNMENT - 1))) & (RAPIDXML_ALIGNMENT - 1));
-            return ptr + alignment;
-        }
-        
-        char *allocate_raw(std::size_t size)
-        {
-            // Allocate
-            void *memory;   
-            if (m_alloc_func)   // Allocate memory using either user-specified allocation function or global operator new[]
+            // Map names to first and last child, growing table to keep it at most half full
+            std::size_t count = 0;
+            if (index->names)
             {
-                memory = m_alloc_func(size);
-                assert(memory); // Allocator is not allowed to return 0, on failure it must either throw, stop the program or use longjmp
+                for (std::size_t i = 0; i <= index->name_mask; ++i)
+                    index->names[i].first = 0;
             }
             else
+                grow_name_table(index, 16);
+            for (xml_node<Ch> *child = node->m_first_node; child; child = child->m_next_sibling)
             {
-                memory = new char[size];
-#ifdef RAPIDXML_NO_EXCEPTIONS
-                if (!memory)            // If exceptions are disabled, verify memory allocation, because new will not be able to throw bad_alloc
-                    RAPIDXML_PARSE_ERROR("out of memory", 0);
-#endif
+                std::uint32_t hash = child->name_hash() ? child->name_hash() : internal::hash(child->name(), child->name_size());
+                typename index_type::name_slot *slot = index->find(child->name(), child->name_size(), hash);
+                if (!slot->first)
+                {
+                    slot->first = child;
+                    slot->hash = hash;
+                    if (2 * ++index->name_count > index->name_mask)
+                        grow_name_table(index, 2 * (index->name_mask + 1));
+                }
+                else
+                    slot->last = child;
+                index->children[count++] = child;
             }
-            return static_cast<char *>(memory);
-        }
-        
-        void *allocate_aligned(std::size_t size)
-        {
-            // Calculate aligned pointer
-            char *result = align(m_ptr);
+            assert(count == index->child_count);
 
-            // If not enough memory left in current pool, allocate a new pool
-            if (result + size > m_end)
+            // Map each child to the next child with the same name
+            std::size_t linked = count - index->name_count;
+            if (linked > 0)
             {
-                // Calculate required pool size (may be bigger than RAPIDXML_DYNAMIC_POOL_SIZE)
-                std::size_t pool_size = RAPIDXML_DYNAMIC_POOL_SIZE;
-                if (pool_size < size)
-                    pool_size = size;
-                
-                // Allocate
-                std::size_t alloc_size = sizeof(header) + (2 * RAPIDXML_ALIGNMENT - 2) + pool_size;     // 2 alignments required in worst case: one for header, one for actual allocation
-                char *raw_memory = allocate_raw(alloc_size);
-                    
-                // Setup new pool in allocated memory
-                char *pool = align(raw_memory);
-                header *new_header = reinterpret_cast<header *>(pool);
-                new_header->previous_begin = m_begin;
-                m_begin = raw_memory;
-                m_ptr = pool + sizeof(header);
-                m_end = raw_memory + alloc_size;
-
-                // Calculate aligned pointer again using new pool
-                result = align(m_ptr);
+                std::size_t node_slots = 16;
+                while (node_slots < 2 * linked)
+                    node_slots *= 2;
+                if (index->nodes && index->node_mask + 1 >= node_slots)
+                    node_slots = index->node_mask + 1;
+                else
+                    index->nodes = static_cast<typename index_type::node_slot *>(allocate_aligned(node_slots * sizeof(typename index_type::node_slot), string_arena));
+                index->node_mask = node_slots - 1;
+                for (std::size_t i = 0; i < node_slots; ++i)
+                    index->nodes[i].node = 0;
+                for (std::size_t i = 0; i <= index->name_mask; ++i)
+                    index->names[i].last = index->names[i].first;
+                for (xml_node<Ch> *child = node->m_first_node; child; child = child->m_next_sibling)
+                {
+                    std::uint32_t hash = child->name_hash() ? child->name_hash() : internal::hash(child->name(), child->name_size());
+                    typename index_type::name_slot *slot = index->find(child->name(), child->name_size(), hash);
+                    if (slot->last != child)
+                    {
+                        std::size_t node_slot = index_type::node_hash(slot->last) & index->node_mask;
+                        while (index->nodes[node_slot].node)
+                            node_slot = (node_slot + 1) & index->node_mask;
+                        index->nodes[node_slot].node = slot->last;
+                        index->nodes[node_slot].next = child;
+                        slot->last = child;
+                    }
+                }
+            }
+            else
+            {
+                // Every name is unique, so each first child is also the last, and node table of a previous index is left empty
+                for (std::size_t i = 0; i <= index->name_mask; ++i)
+                    index->names[i].last = index->names[i].first;
+                if (index->nodes)
+                    for (std::size_t i = 0; i <= index->node_mask; ++i)
+                        index->nodes[i].node = 0;
             }
+            index->valid = true;
+            node->m_child_index = index;
+#else
+            (void)node;
+#endif
+        }
 
-            // Update pool and return aligned pointer
-            m_ptr = result + size;
-            return result;
+        //! Enables or disables segregated arenas.
+        //! By default, nodes, attributes and strings are allocated from the same blocks of memory, interleaved in order of allocation.
+        //! With segregated arenas, each of them is allocated from its own chain of blocks instead,
+        //! so that nodes of the tree are densely packed, 
+        //! and traversals which never read attributes or values touch as few cache lines and pages as possible.
+        //! Static memory of the pool is used for nodes only.
+        //! <br><br>
+        //! This can only be called when no memory is allocated from the pool yet, otherwise results are undefined.
+        //! \param segregated True to allocate nodes, attributes and strings from separate arenas, false to allocate them from a single arena.
+        void set_segregated_arenas(bool segregated)
+        {
+            assert(unused());    // Verify that no memory is allocated yet
+            m_segregated = segregated;
         }
 
-        char *m_begin;                                      // Start of raw memory making up current pool
-        char *m_ptr;                                        // First free byte in current pool
-        char *m_end;                                        // One past last available byte in current pool
-        char m_static_memory[RAPIDXML_STATIC_POOL_SIZE];    // Static raw memory
-        alloc_func *m_alloc_func;                           // Allocator function, or 0 if default is to be used
-        free_func *m_free_func;                             // Free function, or 0 if default is to be used
+        //! Gets whether nodes, attributes and strings are allocated from separate arenas.
+        //! See set_segregated_arenas().
+        //! \return True if arenas are segregated.
+        bool segregated_arenas() const
+        {
+            return m_segregated;
+        }
+
+    protected:
+
+        //! \cond internal
+        // Store count attributes of node as contiguous array, moving them to a new array if they were not allocated one after another
+        void make_attribute_array(xml_node<Ch> *node, std::size_t count)
+        {
+            xml_attribute<Ch> *attribute = node->m_first_attribute;
+            while (attribute->m_next_attribute == attribute + 1)
+                attribute = attribute->m_next_attribute;
+            if (attribute->m_next_attribute)
+            {
+                xml_attribute<Ch> *array = static_cast<xml_attribute<Ch> *>(allocate_aligned(count * sizeof(xml_attribute<Ch>), attribute_arena));
+                attribute = node->m_first_attribute;
+                node->m_first_attribute = 0;
+                node->m_counts.clear_attributes();
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    xml_attribute<Ch> *next = attribute->m_next_attribute;
+                    xml_attribute<Ch> *copy = new(&array[i]) xml_attribute<Ch>;
+                    copy->name(attribute->name(), attribute->name_size());
+                    copy->name_hash(attribute->name_hash());
+                    copy->copy_symbol(attribute);
+                    copy->value(attribute->value(), attribute->value_size());
+                    node->append_attribute(copy);
+                    push_free(m_free_attributes, attribute);
+                    attribute = next;
+                }
+            }
+            node->mark_attribute_array(count);
+        }
+
+        // Copy attributes and descendants of root into new blocks of exactly the required size, in order given by layout flags, and free all other memory of the pool.
+        // Names and values are copied too, so that the tree no longer refers to any memory outside the pool.
+        void compact_tree(xml_node<Ch> *root, int layout)
+        {
+            // Measure the tree
+            std::size_t sizes[arena_count] = { 0, 0, 0 };
+            measure_data(sizes, root);
+            measure_attributes(sizes, root);
+            measure_children(sizes, root);
+            if (!(layout & layout_breadth_first) && (layout & layout_blocked))
+                sizes[node_arena] = measure_blocked(root, sizes[node_arena] / aligned_size(sizeof(xml_node<Ch>)));
+
+            // Allocate a block for each arena, or a single block with nodes, attributes and strings one after another if arenas are not segregated
+            std::size_t overhead = sizeof(header) + (2 * RAPIDXML_ALIGNMENT - 2);
+            char *regions[arena_count];
+            if (m_segregated)
+            {
+                for (int kind = 0; kind < arena_count; ++kind)
+                {
+                    allocate_block(m_arenas[kind], sizes[kind] + overhead);
+                    regions[kind] = align(m_arenas[kind].ptr);
+                }
+            }
+            else
+            {
+                allocate_block(m_arenas[node_arena], sizes[node_arena] + sizes[attribute_arena] + sizes[string_arena] + overhead);
+                regions[node_arena] = align(m_arenas[node_arena].ptr);
+                regions[attribute_arena] = regions[node_arena] + sizes[node_arena];
+                regions[string_arena] = regions[attribute_arena] + sizes[attribute_arena];
+            }
+
+            // Copy the tree to the new blocks, using temporary holder for the new children and attributes of root;
+            // holder is an element even when root is a document, so that it is not mistaken for a document containing the copies
+            xml_node<Ch> holder(node_type::node_element);
+            copy_data(regions, &holder, root);
+            copy_attributes(regions, &holder, root);
+            if (layout & layout_breadth_first)
+                copy_children_breadth_first(regions, &holder, root);
+            else if (layout & layout_blocked)
+                copy_children_blocked(regions, &holder, root);
+            else if (layout & layout_inline_children)
+                copy_children_inline(regions, &holder, root);
+            else
+                copy_children(regions, &holder, root);
+            if (m_segregated)
+            {
+                for (int kind = 0; kind < arena_count; ++kind)
+                    m_arenas[kind].ptr = regions[kind];
+            }
+            else
+                m_arenas[node_arena].ptr = regions[string_arena];
+
+            // Move the copy to root
+            root->remove_all_nodes();
+            root->remove_all_attributes();
+            root->name(holder.name_size() > 0 ? holder.name() : 0, holder.name_size());
+            root->value(holder.value_size() > 0 ? holder.value() : 0, holder.value_size());
+            while (xml_node<Ch> *child = holder.first_node())
+            {
+                holder.remove_first_node();
+                root->append_node(child);
+            }
+            while (xml_attribute<Ch> *attribute = holder.first_attribute())
+            {
+                holder.remove_first_attribute();
+                root->append_attribute(attribute);
+            }
+
+            // Release old memory; freed nodes and attributes lived there too
+            for (int kind = 0; kind < arena_count; ++kind)
+                if (m_arenas[kind].begin != arena_bottom(kind))
+                    free_previous_blocks(kind);
+            m_free_nodes = 0;
+            m_free_attributes = 0;
+            for (std::size_t size_class = 0; size_class < string_classes; ++size_class)
+                m_free_strings[size_class] = 0;
+        }
+        //! \endcond
+
+    private:
+
+        struct header
+        {
+            char *previous_begin;
+            std::size_t size;
+        };
+
+        // Arenas from which nodes, attributes and strings are allocated; only node_arena is used if arenas are not segregated
+        enum
+        {
+            node_arena,
+            attribute_arena,
+            string_arena,
+            arena_count
+        };
+
+        struct arena
+        {
+            char *begin;                                    // Start of raw memory making up current block
+            char *ptr;                                      // First free byte in current block
+            char *end;                                      // One past last available byte in current block
+        };
+
+        // Entry of free list, placed in memory of freed node, attribute or string
+        struct free_slot
+        {
+            free_slot *next;
+        };
+
+        // Freed strings are kept in lists by size class; strings of class k are allocated with string_unit << k bytes
+        static const std::size_t string_unit = (sizeof(free_slot) + RAPIDXML_ALIGNMENT - 1) & ~std::size_t(RAPIDXML_ALIGNMENT - 1);
+        static const std::size_t string_classes = 7;
+
+        static void push_free(free_slot *&list, void *memory)
+        {
+            free_slot *slot = new(memory) free_slot;
+            slot->next = list;
+            list = slot;
+        }
+
+        static void *pop_free(free_slot *&list)
+        {
+            free_slot *slot = list;
+            list = slot->next;
+            return slot;
+        }
+
+        void init()
+        {
+            for (int kind = 0; kind < arena_count; ++kind)
+            {
+                m_arenas[kind].begin = arena_bottom(kind);
+                m_arenas[kind].ptr = align(m_arenas[kind].begin);
+                m_arenas[kind].end = kind == node_arena && m_static_memory ? m_static_memory + m_static_size : 0;
+            }
+            m_free_nodes = 0;
+            m_free_attributes = 0;
+            for (std::size_t size_class = 0; size_class < string_classes; ++size_class)
+                m_free_strings[size_class] = 0;
+        }
+
+        // Allocate name table of child index with given number of slots, moving names already in the table
+        void grow_name_table(internal::child_index<Ch> *index, std::size_t slot_count)
+        {
+            typedef typename internal::child_index<Ch>::name_slot name_slot;
+            name_slot *old_names = index->names;
+            std::size_t old_count = old_names ? index->name_mask + 1 : 0;
+            index->names = static_cast<name_slot *>(allocate_aligned(slot_count * sizeof(name_slot), string_arena));
+            index->name_mask = slot_count - 1;
+            for (std::size_t i = 0; i < slot_count; ++i)
+                index->names[i].first = 0;
+            for (std::size_t i = 0; i < old_count; ++i)
+                if (old_names[i].first)
+                {
+                    std::size_t slot = old_names[i].hash & index->name_mask;
+                    while (index->names[slot].first)
+                        slot = (slot + 1) & index->name_mask;
+                    index->names[slot] = old_names[i];
+                }
+        }
+
+        // Memory at the bottom of block chain of an arena; static memory belongs to node arena
+        char *arena_bottom(int kind) const
+        {
+            return kind == node_arena ? m_static_memory : 0;
+        }
+
+        // Take over memory and settings of other pool, whose memory must already be released, leaving it empty
+        void take(memory_pool &other)
+        {
+            for (int kind = 0; kind < arena_count; ++kind)
+                m_arenas[kind] = other.m_arenas[kind];
+            m_static_memory = other.m_static_memory;
+            m_static_size = other.m_static_size;
+            m_free_nodes = other.m_free_nodes;
+            m_free_attributes = other.m_free_attributes;
+            for (std::size_t size_class = 0; size_class < string_classes; ++size_class)
+                m_free_strings[size_class] = other.m_free_strings[size_class];
+            m_function_resource = other.m_function_resource;
+            m_resource = other.m_resource == &other.m_function_resource ? &m_function_resource : other.m_resource;
+            m_segregated = other.m_segregated;
+
+            // Other pool must not reuse static memory, which holds taken over allocations
+            other.m_static_memory = 0;
+            other.m_static_size = 0;
+            other.init();
+        }
+
+        // Get header of the lowest dynamic block of an arena, which must have at least one
+        header *lowest_block(int kind)
+        {
+            header *lowest = reinterpret_cast<header *>(align(m_arenas[kind].begin));
+            while (lowest->previous_begin != arena_bottom(kind))
+                lowest = reinterpret_cast<header *>(align(lowest->previous_begin));
+            return lowest;
+        }
+
+        // Detach static memory, from which nothing must be in use, from the bottom of node arena, keeping dynamic blocks
+        void detach_static_memory()
+        {
+            arena &nodes = m_arenas[node_arena];
+            if (nodes.begin == m_static_memory)
+            {
+                nodes.begin = 0;
+                nodes.ptr = 0;
+                nodes.end = 0;
+            }
+            else
+                lowest_block(node_arena)->previous_begin = 0;
+            m_static_memory = 0;
+            m_static_size = 0;
+        }
+
+        // Attach static memory to a pool which has none, at the bottom of node arena, so that it serves allocations
+        // right away if there are no dynamic blocks, or once the pool is cleared otherwise
+        void attach_static_memory(char *buffer, std::size_t size)
+        {
+            assert(!m_static_memory);
+            arena &nodes = m_arenas[node_arena];
+            if (nodes.begin)
+                lowest_block(node_arena)->previous_begin = buffer;
+            else
+            {
+                nodes.begin = buffer;
+                nodes.ptr = align(buffer);
+                nodes.end = buffer + size;
+            }
+            m_static_memory = buffer;
+            m_static_size = size;
+        }
+
+        // Check if blocks of other pool can be freed by this pool
+        bool same_allocation(const memory_pool &other) const
+        {
+            if (!m_resource || !other.m_resource)
+                return m_resource == other.m_resource;
+            if (m_resource == &m_function_resource && other.m_resource == &other.m_function_resource)
+                return m_function_resource.same_functions(other.m_function_resource);
+            return m_resource->is_equal(*other.m_resource);
+        }
+
+        // Check if anything was allocated from static memory
+        bool static_memory_used()
+        {
+            if (!m_static_memory)
+                return false;
+            return m_arenas[node_arena].begin != m_static_memory || m_arenas[node_arena].ptr != align(m_static_memory);
+        }
+
+        // Verify that no memory is allocated yet
+        bool unused()
+        {
+            for (int kind = 0; kind < arena_count; ++kind)
+                if (m_arenas[kind].begin != arena_bottom(kind))
+                    return false;
+            return m_arenas[node_arena].ptr == align(m_static_memory);
+        }
+        
+        char *align(char *ptr)
+        {
+            std::size_t alignment = ((RAPIDXML_ALIGNMENT - (std::size_t(ptr) & (RAPIDXML_ALIGNMENT - 1))) & (RAPIDXML_ALIGNMENT - 1));
+            return ptr + alignment;
+        }
+        
+        char *allocate_raw(std::size_t size)
+        {
+            // Allocate
+            void *memory;   
+            if (m_resource)     // Allocate memory using either user-specified memory resource or global operator new[]
+            {
+                memory = m_resource->allocate(size, RAPIDXML_ALIGNMENT);
+                assert(memory); // Allocator is not allowed to return 0, on failure it must either throw, stop the program or use longjmp
+            }
+            else
+            {
+                memory = new char[size];
+#ifdef RAPIDXML_NO_EXCEPTIONS
+                if (!memory)            // If exceptions are disabled, verify memory allocation, because new will not be able to throw bad_alloc
+                    RAPIDXML_PARSE_ERROR("out of memory", 0);
+#endif
+            }
+            return static_cast<char *>(memory);
+        }
+
+        void free_raw(char *memory, std::size_t size)
+        {
+            if (m_resource)
+                m_resource->deallocate(memory, size, RAPIDXML_ALIGNMENT);
+            else
+                delete[] memory;
+        }
+        
+        void *allocate_aligned(std::size_t size, int kind)
+        {
+            arena &current = m_arenas[m_segregated ? kind : node_arena];
+
+            // Calculate aligned pointer
+            char *result = align(current.ptr);
+
+            // If not enough memory left in current pool, allocate a new pool
+            if (result + size > current.end)
+            {
+                // Calculate required pool size (may be bigger than RAPIDXML_DYNAMIC_POOL_SIZE)
+                // Header and alignment overhead is taken from the block, so that regular blocks occupy exactly RAPIDXML_DYNAMIC_POOL_SIZE bytes,
+                // which lets page-based memory resources back them with whole pages
+                std::size_t overhead = sizeof(header) + (2 * RAPIDXML_ALIGNMENT - 2);     // 2 alignments required in worst case: one for header, one for actual allocation
+                std::size_t alloc_size = RAPIDXML_DYNAMIC_POOL_SIZE;
+                if (alloc_size < size + overhead)
+                    alloc_size = size + overhead;
+                
+                // Allocate and make it current pool
+                allocate_block(current, alloc_size);
+
+                // Calculate aligned pointer again using new pool
+                result = align(current.ptr);
+            }
+
+            // Update pool and return aligned pointer
+            current.ptr = result + size;
+            return result;
+        }
+
+        // Get size class of a string of given aligned size, or string_classes if it is too long to be recycled
+        static std::size_t string_class(std::size_t size)
+        {
+            std::size_t size_class = 0;
+            while (size_class < string_classes && (string_unit << size_class) < size)
+                ++size_class;
+            return size_class;
+        }
+
+        // Allocate memory for a string of given aligned size, rounded up to its size class,
+        // reusing a freed string of the same class if there is any
+        void *allocate_string_memory(std::size_t size)
+        {
+            std::size_t size_class = string_class(size);
+            if (size_class == string_classes)
+                return allocate_aligned(size, string_arena);
+            if (m_free_strings[size_class])
+                return pop_free(m_free_strings[size_class]);
+            return allocate_aligned(string_unit << size_class, string_arena);
+        }
+
+        // Check if memory lies in static memory or in a block of the arena strings are allocated from
+        bool owns(const char *memory)
+        {
+            if (m_static_memory && memory >= m_static_memory && memory < m_static_memory + m_static_size)
+                return true;
+            int kind = m_segregated ? string_arena : node_arena;
+            for (char *begin = m_arenas[kind].begin; begin != arena_bottom(kind); )
+            {
+                header *block = reinterpret_cast<header *>(align(begin));
+                if (memory >= begin && memory < begin + block->size)
+                    return true;
+                begin = block->previous_begin;
+            }
+            return false;
+        }
+
+        void allocate_block(arena &current, std::size_t alloc_size)
+        {
+            // Allocate
+            char *raw_memory = allocate_raw(alloc_size);
+                
+            // Setup new pool in allocated memory
+            char *pool = align(raw_memory);
+            header *new_header = reinterpret_cast<header *>(pool);
+            new_header->previous_begin = current.begin;
+            new_header->size = alloc_size;
+            current.begin = raw_memory;
+            current.ptr = pool + sizeof(header);
+            current.end = raw_memory + alloc_size;
+        }
+
+        // Free chain of blocks starting at begin, down to bottom of its arena
+        void free_blocks(char *begin, char *bottom)
+        {
+            while (begin != bottom)
+            {
+                header *block = reinterpret_cast<header *>(align(begin));
+                char *previous_begin = block->previous_begin;
+                free_raw(begin, block->size);
+                begin = previous_begin;
+            }
+        }
+
+        // Free all blocks of arena below current one, and make current block the only dynamic block of the arena
+        void free_previous_blocks(int kind)
+        {
+            header *current = reinterpret_cast<header *>(align(m_arenas[kind].begin));
+            free_blocks(current->previous_begin, arena_bottom(kind));
+            current->previous_begin = arena_bottom(kind);
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // Tree copying
+
+        // Size of memory taken by an allocation, including alignment padding
+        static std::size_t aligned_size(std::size_t size)
+        {
+            return (size + RAPIDXML_ALIGNMENT - 1) & ~std::size_t(RAPIDXML_ALIGNMENT - 1);
+        }
+
+        // Add memory needed by copy_data() for name and value of a node or attribute to sizes
+        static void measure_data(std::size_t *sizes, const xml_base<Ch> *source)
+        {
+            if (source->name_size() > 0)
+                sizes[string_arena] += aligned_size((source->name_size() + 1) * sizeof(Ch));
+            if (source->value_size() > 0)
+                sizes[string_arena] += aligned_size((source->value_size() + 1) * sizeof(Ch));
+        }
+
+        // Add memory needed by copy_attributes() for attributes of a node to sizes
+        static void measure_attributes(std::size_t *sizes, const xml_node<Ch> *source)
+        {
+            for (xml_attribute<Ch> *attribute = source->first_attribute(); attribute; attribute = attribute->next_attribute())
+            {
+                sizes[attribute_arena] += aligned_size(sizeof(xml_attribute<Ch>));
+                measure_data(sizes, attribute);
+            }
+        }
+
+        // Add memory needed by copy_children() for all descendants of a node to sizes
+        static void measure_children(std::size_t *sizes, const xml_node<Ch> *source)
+        {
+            for (const xml_node<Ch> *node = source->first_node(); node; )
+            {
+                sizes[node_arena] += aligned_size(sizeof(xml_node<Ch>));
+                measure_data(sizes, node);
+                measure_attributes(sizes, node);
+
+                // Advance to next node in document order, without leaving the subtree
+                if (node->first_node())
+                    node = node->first_node();
+                else
+                {
+                    while (node != source && !node->next_sibling())
+                        node = node->parent();
+                    node = node == source ? 0 : node->next_sibling();
+                }
+            }
+        }
+
+        // Copy string to string region, adding zero terminator
+        static Ch *copy_string(char **regions, const Ch *source, std::size_t size)
+        {
+            Ch *result = reinterpret_cast<Ch *>(regions[string_arena]);
+            for (std::size_t i = 0; i < size; ++i)
+                result[i] = source[i];
+            result[size] = Ch('\0');
+            regions[string_arena] += aligned_size((size + 1) * sizeof(Ch));
+            return result;
+        }
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+        // Intern names of node, its descendants and attributes which have symbol IDs in symbols, or clear their symbol IDs if symbols is 0
+        static void reintern_symbols(xml_node<Ch> *root, xml_symbol_table<Ch> *symbols)
+        {
+            xml_node<Ch> *node = root;
+            while (node)
+            {
+                reintern_symbol(node, symbols);
+                for (xml_attribute<Ch> *attribute = node->m_first_attribute; attribute; attribute = attribute->m_next_attribute)
+                    reintern_symbol(attribute, symbols);
+                if (node->m_first_node)
+                    node = node->m_first_node;
+                else
+                {
+                    while (node != root && !node->m_next_sibling)
+                        node = node->m_parent;
+                    node = node == root ? 0 : node->m_next_sibling;
+                }
+            }
+        }
+
+        static void reintern_symbol(xml_base<Ch> *base, xml_symbol_table<Ch> *symbols)
+        {
+            if (!base->m_symbol)
+                return;
+            if (symbols)
+                base->m_symbol = symbols->intern(base->name(), base->name_size(), base->name_hash() ? base->name_hash() : internal::hash(base->name(), base->name_size()));
+            else
+                base->m_symbol = 0;
+        }
+#endif
+
+        // Copy name and value to string region
+        static void copy_data(char **regions, xml_base<Ch> *dest, const xml_base<Ch> *source)
+        {
+            if (source->name_size() > 0)
+            {
+                dest->name(copy_string(regions, source->name(), source->name_size()), source->name_size());
+                dest->name_hash(source->name_hash());
+                dest->copy_symbol(source);
+            }
+            if (source->value_size() > 0)
+                dest->value(copy_string(regions, source->value(), source->value_size()), source->value_size());
+        }
+
+        // Copy attributes to attribute region, with their names and values, appending them to dest
+        static void copy_attributes(char **regions, xml_node<Ch> *dest, const xml_node<Ch> *source)
+        {
+            std::size_t count = 0;
+            for (xml_attribute<Ch> *attribute = source->first_attribute(); attribute; attribute = attribute->next_attribute())
+            {
+                xml_attribute<Ch> *copy = new(regions[attribute_arena]) xml_attribute<Ch>;
+                regions[attribute_arena] += aligned_size(sizeof(xml_attribute<Ch>));
+                copy_data(regions, copy, attribute);
+                dest->link_last_attribute(copy);
+                ++count;
+            }
+
+            // Copies are adjacent, so they form an array unless alignment pads them
+            if (aligned_size(sizeof(xml_attribute<Ch>)) == sizeof(xml_attribute<Ch>))
+                dest->mark_attribute_array(count);
+        }
+
+        // Copy all descendants of source to node region in document order, with their attributes, names and values, appending them to dest.
+        // Each region must be at least as large as measured by measure_children().
+        static void copy_children(char **regions, xml_node<Ch> *dest, const xml_node<Ch> *source)
+        {
+            const xml_node<Ch> *node = source->first_node();
+            while (node)
+            {
+                xml_node<Ch> *copy = new(regions[node_arena]) xml_node<Ch>(node->type());
+                regions[node_arena] += aligned_size(sizeof(xml_node<Ch>));
+                copy_data(regions, copy, node);
+                copy_attributes(regions, copy, node);
+                dest->link_last_node(copy);
+
+                // Advance to next node in document order, keeping dest as parent of copy of node
+                if (node->first_node())
+                {
+                    dest = copy;
+                    node = node->first_node();
+                }
+                else
+                {
+                    while (node != source && !node->next_sibling())
+                    {
+                        node = node->parent();
+                        dest = dest->parent();
+                    }
+                    node = node == source ? 0 : node->next_sibling();
+                }
+            }
+        }
+
+        // Copy children of source of dest next to each other to node region, with their attributes, names and values, appending them to dest.
+        // While a copied node waits for its children to be copied, its first node pointer holds its source node.
+        static void copy_child_array(char **regions, xml_node<Ch> *dest)
+        {
+            const xml_node<Ch> *source = dest->m_first_node;
+            dest->m_first_node = 0;
+            for (xml_node<Ch> *child = source->first_node(); child; child = child->next_sibling())
+            {
+                xml_node<Ch> *copy = new(regions[node_arena]) xml_node<Ch>(child->type());
+                regions[node_arena] += aligned_size(sizeof(xml_node<Ch>));
+                copy_data(regions, copy, child);
+                copy_attributes(regions, copy, child);
+                dest->link_last_node(copy);
+                copy->m_first_node = child;
+            }
+        }
+
+        // Copy all descendants of source like copy_children(), but level by level
+        static void copy_children_breadth_first(char **regions, xml_node<Ch> *dest, const xml_node<Ch> *source)
+        {
+            // Node region itself is the queue of nodes waiting for their children
+            char *queue = regions[node_arena];
+            dest->m_first_node = const_cast<xml_node<Ch> *>(source);
+            copy_child_array(regions, dest);
+            for (; queue != regions[node_arena]; queue += aligned_size(sizeof(xml_node<Ch>)))
+                copy_child_array(regions, reinterpret_cast<xml_node<Ch> *>(queue));
+        }
+
+        // Copy all descendants of source like copy_children(), but with children of each node copied before subtree of its first child
+        static void copy_children_inline(char **regions, xml_node<Ch> *dest, const xml_node<Ch> *source)
+        {
+            dest->m_first_node = const_cast<xml_node<Ch> *>(source);
+            copy_child_array(regions, dest);
+            for (xml_node<Ch> *node = dest->first_node(); node; )
+            {
+                copy_child_array(regions, node);
+
+                // Advance to next copied node in document order, without leaving the copy
+                if (node->first_node())
+                    node = node->first_node();
+                else
+                {
+                    while (node != dest && !node->next_sibling())
+                        node = node->parent();
+                    node = node == dest ? 0 : node->next_sibling();
+                }
+            }
+        }
+
+        // Size of blocks of blocked layout; it must be a multiple of RAPIDXML_ALIGNMENT
+        static std::size_t layout_block_size()
+        {
+            const std::size_t node_size = aligned_size(sizeof(xml_node<Ch>));
+            return RAPIDXML_LAYOUT_BLOCK_SIZE > node_size ? RAPIDXML_LAYOUT_BLOCK_SIZE : node_size;
+        }
+
+        // Get offset, relative to a block boundary, at which a block starting with count nodes is placed, given offset of free memory:
+        // the block continues the current one if the nodes fit before its end, otherwise it starts at the next boundary
+        static std::size_t layout_block_start(std::size_t offset, std::size_t count)
+        {
+            const std::size_t block_size = layout_block_size();
+            std::size_t end = (offset / block_size + 1) * block_size;
+            if (offset % block_size == 0 || offset + count * aligned_size(sizeof(xml_node<Ch>)) <= end)
+                return offset;
+            return end;
+        }
+
+        // Get size of node region needed by copy_children_blocked() for count descendants of source, including padding which aligns blocks.
+        // Layout is computed by placing pointers to source nodes in scratch memory, exactly as copy_children_blocked() places their copies.
+        std::size_t measure_blocked(const xml_node<Ch> *source, std::size_t count)
+        {
+            const std::size_t node_size = aligned_size(sizeof(xml_node<Ch>));
+            const std::size_t block_size = layout_block_size();
+            std::size_t scratch_size = (2 * count + 1) * sizeof(const xml_node<Ch> *);
+            const xml_node<Ch> **placed = reinterpret_cast<const xml_node<Ch> **>(allocate_raw(scratch_size));
+            const xml_node<Ch> **pending = placed + count;
+            std::size_t placed_count = 0, pending_count = 0, offset = 0;
+            pending[pending_count++] = source;
+            while (pending_count > 0)
+            {
+                const xml_node<Ch> *top = pending[--pending_count];
+                std::size_t children = 0;
+                for (const xml_node<Ch> *child = top->first_node(); child; child = child->next_sibling())
+                    ++children;
+                offset = layout_block_start(offset, children);
+                std::size_t end = (offset / block_size + 1) * block_size;
+                std::size_t scan = placed_count;
+                for (const xml_node<Ch> *child = top->first_node(); child; child = child->next_sibling())
+                    placed[placed_count++] = child;
+                offset += children * node_size;
+                for (; scan != placed_count; ++scan)
+                {
+                    children = 0;
+                    for (const xml_node<Ch> *child = placed[scan]->first_node(); child; child = child->next_sibling())
+                        ++children;
+                    if (offset + children * node_size > end)
+                        break;
+                    for (const xml_node<Ch> *child = placed[scan]->first_node(); child; child = child->next_sibling())
+                        placed[placed_count++] = child;
+                    offset += children * node_size;
+                }
+                for (std::size_t rest = placed_count; rest != scan; )
+                    if (placed[--rest]->first_node())
+                        pending[pending_count++] = placed[rest];
+            }
+            free_raw(reinterpret_cast<char *>(placed), scratch_size);
+            return offset + block_size - RAPIDXML_ALIGNMENT;    // Region itself may need that much padding to start at a boundary
+        }
+
+        // Copy all descendants of source like copy_children(), but in blocks of RAPIDXML_LAYOUT_BLOCK_SIZE bytes filled breadth-first.
+        // Blocks lie between boundaries at multiples of block size; a block which does not fit before the next boundary starts at it.
+        // Node region must be at least as large as measured by measure_blocked().
+        static void copy_children_blocked(char **regions, xml_node<Ch> *dest, const xml_node<Ch> *source)
+        {
+            const std::size_t node_size = aligned_size(sizeof(xml_node<Ch>));
+            const std::size_t block_size = layout_block_size();
+            std::size_t misalignment = reinterpret_cast<std::size_t>(regions[node_arena]) % block_size;
+            char *base = misalignment ? regions[node_arena] + (block_size - misalignment) : regions[node_arena];
+
+            // Nodes whose children did not fit into block of their parent wait on a stack, linked through their last node pointers
+            dest->m_first_node = const_cast<xml_node<Ch> *>(source);
+            dest->m_last_node = 0;
+            xml_node<Ch> *pending = dest;
+            std::size_t offset = 0;
+            while (pending)
+            {
+                xml_node<Ch> *top = pending;
+                pending = top->m_last_node;
+
+                // Start a new block with children of top, even if they do not fit, and fill it breadth-first up to the next boundary
+                std::size_t count = 0;
+                for (xml_node<Ch> *child = top->m_first_node->first_node(); child; child = child->next_sibling())
+                    ++count;
+                offset = layout_block_start(offset, count);
+                char *end = base + (offset / block_size + 1) * block_size;
+                regions[node_arena] = base + offset;
+                char *scan = regions[node_arena];
+                copy_child_array(regions, top);
+                for (; scan != regions[node_arena]; scan += node_size)
+                {
+                    xml_node<Ch> *node = reinterpret_cast<xml_node<Ch> *>(scan);
+                    count = 0;
+                    for (xml_node<Ch> *child = node->m_first_node->first_node(); child; child = child->next_sibling())
+                        ++count;
+                    if (regions[node_arena] + count * node_size > end)
+                        break;
+                    copy_child_array(regions, node);
+                }
+                offset = static_cast<std::size_t>(regions[node_arena] - base);
+
+                // Remaining nodes of the block with children start blocks of their own, pushed in reverse so that they are popped in document order
+                for (char *rest = regions[node_arena]; rest != scan; )
+                {
+                    rest -= node_size;
+                    xml_node<Ch> *node = reinterpret_cast<xml_node<Ch> *>(rest);
+                    if (node->m_first_node->first_node())
+                    {
+                        node->m_last_node = pending;
+                        pending = node;
+                    }
+                    else
+                        node->m_first_node = 0;
+                }
+            }
+        }
+
+        arena m_arenas[arena_count];                        // Current blocks of node, attribute and string arenas
+        char *m_static_memory;                              // Static raw memory, or 0 if none
+        std::size_t m_static_size;                          // Size of static raw memory
+        free_slot *m_free_nodes;                            // Freed nodes available for reuse, or 0 if none
+        free_slot *m_free_attributes;                       // Freed attributes available for reuse, or 0 if none
+        free_slot *m_free_strings[string_classes];          // Freed strings available for reuse, by size class
+        std::pmr::memory_resource *m_resource;              // Memory resource for dynamic blocks, or 0 if default is to be used
+        internal::function_resource m_function_resource;    // Adapter for functions passed to set_allocator()
+        bool m_segregated;                                  // Whether nodes, attributes and strings are allocated from separate arenas
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Symbol table
+
+    //! Table of interned names, mapping each distinct name to a small integer symbol ID.
+    //! Symbol IDs are assigned consecutively starting from 1, in order of interning; 0 is never a valid symbol ID.
+    //! <br><br>
+    //! Table can be used by one document, or shared by many documents, so that their symbol IDs agree;
+    //! see xml_document::set_symbol_table() and rapidxml::parse_intern_names flag.
+    //! Names are copied into memory owned by the table, so the table does not depend on source text or on any document,
+    //! but it must outlive all documents parsed with it, as long as their symbol IDs are used.
+    //! <br><br>
+    //! Interning is not thread safe. Documents sharing a table must not be parsed concurrently, 
+    //! unless all their names are already interned; lookups with find() may run concurrently with each other.
+    //! \param Ch Character type of names.
+    template<class Ch = char>
+    class xml_symbol_table
+    {
+
+    public:
+
+        //! Constructs empty symbol table.
+        //! \param resource Memory resource to allocate memory of the table from, or 0 to use global <code>new</code> and <code>delete</code>.
+        explicit xml_symbol_table(std::pmr::memory_resource *resource = 0)
+            : m_strings(resource)
+            , m_resource(resource ? resource : std::pmr::new_delete_resource())
+            , m_entries(0)
+            , m_slots(0)
+            , m_slot_count(0)
+            , m_count(0)
+        {
+        }
+
+        //! Destroys symbol table and frees all memory of the table.
+        ~xml_symbol_table()
+        {
+            release();
+        }
+
+        //! Interns a name, adding it to the table unless already present.
+        //! \param name Name to intern; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of name, in characters, or 0 to have size calculated automatically from string.
+        //! \return Symbol ID of the name.
+        std::uint32_t intern(const Ch *name, std::size_t size = 0)
+        {
+            if (size == 0)
+                size = internal::measure(name);
+            return intern(name, size, internal::hash(name, size));
+        }
+
+        //! Interns a name whose hash is already known, adding it to the table unless already present.
+        //! \param name Name to intern; this string doesn't have to be zero-terminated.
+        //! \param size Size of name, in characters.
+        //! \param hash Hash of name, as returned by xml_base::name_hash().
+        //! \return Symbol ID of the name.
+        std::uint32_t intern(const Ch *name, std::size_t size, std::uint32_t hash)
+        {
+            if (2 * (m_count + 1) > m_slot_count)
+                grow();
+            std::size_t mask = m_slot_count - 1;
+            for (std::size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+            {
+                std::uint32_t symbol = m_slots[slot];
+                if (!symbol)
+                {
+                    // Add new symbol, with name copied to memory of the table
+                    entry &added = m_entries[m_count];
+                    added.name = m_strings.allocate_string(0, size + 1);
+                    for (std::size_t i = 0; i < size; ++i)
+                        added.name[i] = name[i];
+                    added.name[size] = Ch('\0');
+                    added.size = size;
+                    added.hash = hash;
+                    symbol = static_cast<std::uint32_t>(++m_count);
+                    m_slots[slot] = symbol;
+                    return symbol;
+                }
+                const entry &existing = m_entries[symbol - 1];
+                if (existing.hash == hash && internal::compare(existing.name, existing.size, name, size, true))
+                    return symbol;
+            }
+        }
+
+        //! Finds symbol ID of a name, without adding it to the table.
+        //! \param name Name to find; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of name, in characters, or 0 to have size calculated automatically from string.
+        //! \return Symbol ID of the name, or 0 if name is not in the table.
+        std::uint32_t find(const Ch *name, std::size_t size = 0) const
+        {
+            if (size == 0)
+                size = internal::measure(name);
+            if (m_count == 0)
+                return 0;
+            std::uint32_t hash = internal::hash(name, size);
+            std::size_t mask = m_slot_count - 1;
+            for (std::size_t slot = hash & mask; m_slots[slot]; slot = (slot + 1) & mask)
+            {
+                const entry &existing = m_entries[m_slots[slot] - 1];
+                if (existing.hash == hash && internal::compare(existing.name, existing.size, name, size, true))
+                    return m_slots[slot];
+            }
+            return 0;
+        }
+
+        //! Gets name of a symbol.
+        //! \param symbol Symbol ID, as returned by intern(); behaviour is undefined if it is not in the table.
+        //! \return Zero-terminated name of the symbol.
+        const Ch *name(std::uint32_t symbol) const
+        {
+            assert(symbol > 0 && symbol <= m_count);
+            return m_entries[symbol - 1].name;
+        }
+
+        //! Gets size of name of a symbol.
+        //! \param symbol Symbol ID, as returned by intern(); behaviour is undefined if it is not in the table.
+        //! \return Size of name, in characters, not including terminator.
+        std::size_t name_size(std::uint32_t symbol) const
+        {
+            assert(symbol > 0 && symbol <= m_count);
+            return m_entries[symbol - 1].size;
+        }
+
+        //! Gets number of symbols in the table, which is also the largest symbol ID.
+        //! \return Number of symbols.
+        std::size_t size() const
+        {
+            return m_count;
+        }
+
+        //! Removes all symbols from the table and frees its memory.
+        //! Symbol IDs stored in nodes and attributes of documents parsed with the table are no longer meaningful.
+        void clear()
+        {
+            release();
+            m_strings.clear();
+            m_count = 0;
+        }
+
+    private:
+
+        struct entry
+        {
+            Ch *name;
+            std::size_t size;
+            std::uint32_t hash;
+        };
+
+        // No copying
+        xml_symbol_table(const xml_symbol_table &);
+        void operator =(const xml_symbol_table &);
+
+        // Double number of slots and entries, keeping at most half of the slots used
+        void grow()
+        {
+            std::size_t slot_count = m_slot_count ? 2 * m_slot_count : 64;
+            entry *entries = static_cast<entry *>(m_resource->allocate(slot_count / 2 * sizeof(entry), alignof(entry)));
+            std::uint32_t *slots = static_cast<std::uint32_t *>(m_resource->allocate(slot_count * sizeof(std::uint32_t), alignof(std::uint32_t)));
+            for (std::size_t slot = 0; slot < slot_count; ++slot)
+                slots[slot] = 0;
+            for (std::size_t i = 0; i < m_count; ++i)
+            {
+                entries[i] = m_entries[i];
+                std::size_t slot = entries[i].hash & (slot_count - 1);
+                while (slots[slot])
+                    slot = (slot + 1) & (slot_count - 1);
+                slots[slot] = static_cast<std::uint32_t>(i + 1);
+            }
+            release();
+            m_entries = entries;
+            m_slots = slots;
+            m_slot_count = slot_count;
+        }
+
+        // Free slots and entries; names are left in memory pool
+        void release()
+        {
+            if (m_slots)
+            {
+                m_resource->deallocate(m_entries, m_slot_count / 2 * sizeof(entry), alignof(entry));
+                m_resource->deallocate(m_slots, m_slot_count * sizeof(std::uint32_t), alignof(std::uint32_t));
+            }
+            m_entries = 0;
+            m_slots = 0;
+            m_slot_count = 0;
+        }
+
+        memory_pool<Ch> m_strings;                  // Names of symbols
+        std::pmr::memory_resource *m_resource;      // Resource for entries and slots
+        entry *m_entries;                           // Entries of symbols, indexed by symbol ID minus 1
+        std::uint32_t *m_slots;                     // Open addressing hash table of symbol IDs, 0 for empty slots
+        std::size_t m_slot_count;                   // Number of slots, a power of 2, or 0 if none
+        std::size_t m_count;                        // Number of symbols
+
     };
 
     ///////////////////////////////////////////////////////////////////////////
@@ -649,6 +2254,9 @@ namespace rapidxml
     class xml_base
     {
 
+        friend class memory_pool<Ch>;
+        friend class xml_document<Ch, 0>;
+
     public:
         
         ///////////////////////////////////////////////////////////////////////////
@@ -656,6 +2264,12 @@ namespace rapidxml
     
         // Construct a base with empty name, value and parent
         xml_base() : m_name(0), m_value(0), m_name_size(0), m_value_size(0), m_parent(0)
+#ifdef RAPIDXML_NAME_HASHES
+            , m_name_hash(0)
+#endif
+#ifdef RAPIDXML_NAME_SYMBOLS
+            , m_symbol(0)
+#endif
         {
 
         }
@@ -701,6 +2315,33 @@ namespace rapidxml
             return m_value ? m_value_size : 0;
         }
 
+        //! Gets hash of name, which is used to speed up case-sensitive named lookups.
+        //! Hash is computed by the parser if rapidxml::parse_name_hashes flag was selected, or by hash_name(),
+        //! and is discarded whenever name is set.
+        //! Hashes are only kept if <code>RAPIDXML_NAME_HASHES</code> is defined.
+        //! \return 32-bit hash of name, or 0 if hash was not computed.
+        std::uint32_t name_hash() const
+        {
+#ifdef RAPIDXML_NAME_HASHES
+            return m_name_hash;
+#else
+            return 0;
+#endif
+        }
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+        //! Gets symbol ID of name, which identifies the name in a symbol table.
+        //! Symbol ID is assigned by the parser if rapidxml::parse_intern_names flag was selected, or by intern_name(),
+        //! and is discarded whenever name is set.
+        //! If document was parsed with a vocabulary, see xml_vocabulary, symbol ID is instead position of name in the vocabulary, or 0 for unknown names.
+        //! This function is only available if <code>RAPIDXML_NAME_SYMBOLS</code> is defined.
+        //! \return Symbol ID of name, or 0 if name was not interned.
+        std::uint32_t symbol() const
+        {
+            return m_symbol;
+        }
+#endif
+
         ///////////////////////////////////////////////////////////////////////////
         // Node modification
     
@@ -721,6 +2362,10 @@ namespace rapidxml
         {
             m_name = const_cast<Ch *>(name);
             m_name_size = size;
+            name_hash(0);
+            symbol(0);
+            if (m_parent)
+                m_parent->modified();
         }
 
         //! Sets name of node to a zero-terminated string.
@@ -731,6 +2376,30 @@ namespace rapidxml
             this->name(name, internal::measure(name));
         }
 
+        //! Computes and stores hash of current name, so that named lookups compare hashes first.
+        //! Use it on nodes and attributes created or renamed after parsing, 
+        //! which are frequently looked up by name in documents parsed with rapidxml::parse_name_hashes flag.
+        //! See name_hash(); this function does nothing unless <code>RAPIDXML_NAME_HASHES</code> is defined.
+        void hash_name()
+        {
+#ifdef RAPIDXML_NAME_HASHES
+            m_name_hash = internal::hash(name(), name_size());
+#endif
+        }
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+        //! Interns current name in a symbol table and stores its symbol ID, computing hash of name as well.
+        //! Use it on nodes and attributes created or renamed after parsing, so that they can be found by symbol ID.
+        //! See symbol().
+        //! \param table Symbol table to intern name in; normally the symbol table of the document.
+        void intern_name(xml_symbol_table<Ch> &table)
+        {
+            std::uint32_t hash = internal::hash(name(), name_size());
+            name_hash(hash);
+            m_symbol = table.intern(name(), name_size(), hash);
+        }
+#endif
+
         //! Sets value of node to a non zero-terminated string.
         //! See \ref ownership_of_strings.
         //! <br><br>
@@ -751,6 +2420,8 @@ namespace rapidxml
         {
             m_value = const_cast<Ch *>(value);
             m_value_size = size;
+            if (m_parent)
+                m_parent->modified();
         }
 
         //! Sets value of node to a zero-terminated string.
@@ -780,11 +2451,60 @@ namespace rapidxml
             return &zero;
         }
 
+        // Store hash of name, if hashes are kept
+        void name_hash(std::uint32_t hash)
+        {
+#ifdef RAPIDXML_NAME_HASHES
+            m_name_hash = hash;
+#else
+            (void)hash;
+#endif
+        }
+
+        // Store symbol ID of name, if symbol IDs are kept
+        void symbol(std::uint32_t symbol)
+        {
+#ifdef RAPIDXML_NAME_SYMBOLS
+            m_symbol = symbol;
+#else
+            (void)symbol;
+#endif
+        }
+
+        // Copy symbol ID of name from a node or attribute with the same name, if symbol IDs are kept
+        void copy_symbol(const xml_base<Ch> *source)
+        {
+#ifdef RAPIDXML_NAME_SYMBOLS
+            m_symbol = source->m_symbol;
+#else
+            (void)source;
+#endif
+        }
+
+        // Check if name equals given name, comparing hashes first if both are known; hash of given name is computed once and cached in hash
+        bool name_equals(const Ch *name, std::size_t size, bool case_sensitive, std::uint32_t &hash) const
+        {
+            if (name_hash() && case_sensitive)
+            {
+                if (!hash)
+                    hash = internal::hash(name, size);
+                if (hash != name_hash())
+                    return false;
+            }
+            return internal::compare(this->name(), name_size(), name, size, case_sensitive);
+        }
+
         Ch *m_name;                         // Name of node, or 0 if no name
         Ch *m_value;                        // Value of node, or 0 if no value
         std::size_t m_name_size;            // Length of node name, or undefined of no name
         std::size_t m_value_size;           // Length of node value, or undefined if no value
         xml_node<Ch> *m_parent;             // Pointer to parent node, or 0 if none
+#ifdef RAPIDXML_NAME_HASHES
+        std::uint32_t m_name_hash;          // Hash of name, or 0 if not computed
+#endif
+#ifdef RAPIDXML_NAME_SYMBOLS
+        std::uint32_t m_symbol;             // Symbol ID of name, or 0 if not interned
+#endif
 
     };
 
@@ -798,6 +2518,7 @@ namespace rapidxml
     {
 
         friend class xml_node<Ch>;
+        friend class memory_pool<Ch>;
     
     public:
 
@@ -815,13 +2536,13 @@ namespace rapidxml
     
         //! Gets document of which attribute is a child.
         //! \return Pointer to document that contains this attribute, or 0 if there is no parent document.
-        xml_document<Ch> *document() const
+        xml_document<Ch, 0> *document() const
         {
             if (xml_node<Ch> *node = this->parent())
             {
                 while (node->parent())
                     node = node->parent();
-                return node->type() == node_type::node_document ? static_cast<xml_document<Ch> *>(node) : 0;
+                return node->type() == node_type::node_document ? static_cast<xml_document<Ch, 0> *>(node) : 0;
             }
             else
                 return 0;
@@ -838,8 +2559,9 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                std::uint32_t hash = 0;
                 for (xml_attribute<Ch> *attribute = m_prev_attribute; attribute; attribute = attribute->m_prev_attribute)
-                    if (internal::compare(attribute->name(), attribute->name_size(), name, name_size, case_sensitive))
+                    if (attribute->name_equals(name, name_size, case_sensitive, hash))
                         return attribute;
                 return 0;
             }
@@ -858,8 +2580,9 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                std::uint32_t hash = 0;
                 for (xml_attribute<Ch> *attribute = m_next_attribute; attribute; attribute = attribute->m_next_attribute)
-                    if (internal::compare(attribute->name(), attribute->name_size(), name, name_size, case_sensitive))
+                    if (attribute->name_equals(name, name_size, case_sensitive, hash))
                         return attribute;
                 return 0;
             }
@@ -867,6 +2590,23 @@ namespace rapidxml
                 return this->m_parent ? m_next_attribute : 0;
         }
 
+#ifdef RAPIDXML_NAME_SYMBOLS
+        //! Gets next attribute whose name has given symbol ID.
+        //! This function is only available if <code>RAPIDXML_NAME_SYMBOLS</code> is defined.
+        //! \param symbol Symbol ID of name, see xml_base::symbol(); must not be 0.
+        //! \return Pointer to found attribute, or 0 if not found.
+        xml_attribute<Ch> *next_attribute_by_symbol(std::uint32_t symbol) const
+        {
+            assert(symbol);
+            if (!this->m_parent)
+                return 0;
+            for (xml_attribute<Ch> *attribute = m_next_attribute; attribute; attribute = attribute->m_next_attribute)
+                if (attribute->m_symbol == symbol)
+                    return attribute;
+            return 0;
+        }
+#endif
+
     private:
 
         xml_attribute<Ch> *m_prev_attribute;        // Pointer to previous sibling of attribute, or 0 if none; only valid if parent is non-zero
@@ -889,6 +2629,9 @@ namespace rapidxml
     class xml_node: public xml_base<Ch>
     {
 
+        friend class memory_pool<Ch>;
+        friend class xml_document<Ch, 0>;
+
     public:
 
         ///////////////////////////////////////////////////////////////////////////
@@ -897,7 +2640,16 @@ namespace rapidxml
         //! Constructs an empty node with the specified type. 
         //! Consider using memory_pool of appropriate document to allocate nodes manually.
         //! \param type Type of node to construct.
-        xml_node(node_type type) : m_type(type), m_first_node(0), m_last_node(nullptr), m_first_attribute(0), m_last_attribute(nullptr), m_prev_sibling(nullptr), m_next_sibling(nullptr)
+        xml_node(node_type type) : m_type(type), m_tracked(false), m_first_node(0), m_last_node(nullptr), m_first_attribute(0), m_last_attribute(nullptr), m_prev_sibling(nullptr), m_next_sibling(nullptr)
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+            , m_attribute_array(0)
+#endif
+#ifdef RAPIDXML_CHILD_INDEX
+            , m_child_index(0)
+#endif
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            , m_next_in_order(0)
+#endif
         {
         }
 
@@ -916,12 +2668,12 @@ namespace rapidxml
     
         //! Gets document of which node is a child.
         //! \return Pointer to document that contains this node, or 0 if there is no parent document.
-        xml_document<Ch> *document() const
+        xml_document<Ch, 0> *document() const
         {
             xml_node<Ch> *node = const_cast<xml_node<Ch> *>(this);
             while (node->parent())
                 node = node->parent();
-            return node->type() == node_type::node_document ? static_cast<xml_document<Ch> *>(node) : 0;
+            return node->type() == node_type::node_document ? static_cast<xml_document<Ch, 0> *>(node) : 0;
         }
 
         //! Gets first child node, optionally matching node name.
@@ -935,8 +2687,11 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                if (valid_child_index() && case_sensitive)
+                    return valid_child_index()->find(name, name_size, internal::hash(name, name_size))->first;
+                std::uint32_t hash = 0;
                 for (xml_node<Ch> *child = m_first_node; child; child = child->next_sibling())
-                    if (internal::compare(child->name(), child->name_size(), name, name_size, case_sensitive))
+                    if (child->name_equals(name, name_size, case_sensitive, hash))
                         return child;
                 return 0;
             }
@@ -944,6 +2699,128 @@ namespace rapidxml
                 return m_first_node;
         }
 
+        //! Gets first child node with given name, whose hash is already known, for example because it was computed at compile time.
+        //! Name comparison is case-sensitive.
+        //! \param name Name of child to find; this string doesn't have to be zero-terminated.
+        //! \param name_size Size of name, in characters.
+        //! \param hash Hash of name, as computed by xml_base::hash_name(); must not be 0.
+        //! \return Pointer to found child, or 0 if not found.
+        xml_node<Ch> *first_node_hashed(const Ch *name, std::size_t name_size, std::uint32_t hash) const
+        {
+            assert(name && hash);
+            if (valid_child_index())
+                return valid_child_index()->find(name, name_size, hash)->first;
+            for (xml_node<Ch> *child = m_first_node; child; child = child->next_sibling())
+                if (child->name_equals(name, name_size, true, hash))
+                    return child;
+            return 0;
+        }
+
+#ifdef RAPIDXML_NAME_SYMBOLS
+        //! Gets first child node whose name has given symbol ID.
+        //! This function is only available if <code>RAPIDXML_NAME_SYMBOLS</code> is defined.
+        //! \param symbol Symbol ID of name, see xml_base::symbol(); must not be 0.
+        //! \return Pointer to found child, or 0 if not found.
+        xml_node<Ch> *first_node_by_symbol(std::uint32_t symbol) const
+        {
+            assert(symbol);
+            for (xml_node<Ch> *child = m_first_node; child; child = child->m_next_sibling)
+                if (child->m_symbol == symbol)
+                    return child;
+            return 0;
+        }
+#endif
+
+        //! Gets next node in document order: first child, or next sibling, or next sibling of nearest ancestor having one.
+        //! If <code>RAPIDXML_DOCUMENT_ORDER</code> is defined, this takes constant time, 
+        //! but link is only valid if xml_document::document_order_linked() is true for the document of the node;
+        //! it is set by the parser if rapidxml::parse_document_order flag was specified, or by xml_document::link_document_order().
+        //! Otherwise, next node is found by walking up the tree, which takes time proportional to depth of the node.
+        //! \return Pointer to next node in document order, or 0 if node is the last one.
+        xml_node<Ch> *next_in_document_order() const
+        {
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            return m_next_in_order;
+#else
+            if (m_first_node)
+                return m_first_node;
+            const xml_node<Ch> *node = this;
+            while (node->m_parent && !node->m_next_sibling)
+                node = node->m_parent;
+            return node->m_parent ? node->m_next_sibling : 0;
+#endif
+        }
+
+        //! Checks if children of node have a hash index, see memory_pool::index_children().
+        //! \return True if children are indexed.
+        bool indexed_children() const
+        {
+            return valid_child_index() != 0;
+        }
+
+        //! Gets number of child nodes.
+        //! If <code>RAPIDXML_NODE_COUNTS</code> is defined, count is maintained by the parser and by functions adding and removing children, 
+        //! so this takes constant time, as it does when children of node are indexed, see memory_pool::index_children(); 
+        //! otherwise children are counted.
+        //! \return Number of children of node.
+        std::size_t child_count() const
+        {
+#ifdef RAPIDXML_NODE_COUNTS
+            return m_counts.children;
+#else
+            if (valid_child_index())
+                return valid_child_index()->child_count;
+            std::size_t count = 0;
+            for (xml_node<Ch> *child = m_first_node; child; child = child->m_next_sibling)
+                ++count;
+            return count;
+#endif
+        }
+
+        //! Gets number of attributes.
+        //! If <code>RAPIDXML_NODE_COUNTS</code> is defined, count is maintained by the parser and by functions adding and removing attributes, 
+        //! so this takes constant time; otherwise attributes are counted.
+        //! \return Number of attributes of node.
+        std::size_t attribute_count() const
+        {
+#ifdef RAPIDXML_NODE_COUNTS
+            return m_counts.attributes;
+#else
+            std::size_t count = 0;
+            for (xml_attribute<Ch> *attribute = m_first_attribute; attribute; attribute = attribute->m_next_attribute)
+                ++count;
+            return count;
+#endif
+        }
+
+        //! Gets child node at given position.
+        //! If children of node are indexed, see memory_pool::index_children(), this takes constant time;
+        //! otherwise children are walked, from the nearer end if <code>RAPIDXML_NODE_COUNTS</code> is defined.
+        //! \param index Zero-based position of child.
+        //! \return Pointer to child, or 0 if node does not have that many children.
+        xml_node<Ch> *nth_child(std::size_t index) const
+        {
+            if (valid_child_index())
+                return index < valid_child_index()->child_count ? valid_child_index()->children[index] : 0;
+#ifdef RAPIDXML_NODE_COUNTS
+            if (index >= m_counts.children)
+                return 0;
+            xml_node<Ch> *child;
+            if (index < m_counts.children / 2)
+                for (child = m_first_node; index > 0; --index)
+                    child = child->m_next_sibling;
+            else
+                for (child = m_last_node, index = m_counts.children - 1 - index; index > 0; --index)
+                    child = child->m_prev_sibling;
+            return child;
+#else
+            xml_node<Ch> *child = m_first_node;
+            for (; child && index > 0; --index)
+                child = child->m_next_sibling;
+            return child;
+#endif
+        }
+
         //! Gets last child node, optionally matching node name. 
         //! Behaviour is undefined if node has no children.
         //! Use first_node() to test if node has children.
@@ -958,8 +2835,14 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                if (valid_child_index() && case_sensitive)
+                {
+                    typename internal::child_index<Ch>::name_slot *slot = valid_child_index()->find(name, name_size, internal::hash(name, name_size));
+                    return slot->first ? slot->last : 0;
+                }
+                std::uint32_t hash = 0;
                 for (xml_node<Ch> *child = m_last_node; child; child = child->previous_sibling())
-                    if (internal::compare(child->name(), child->name_size(), name, name_size, case_sensitive))
+                    if (child->name_equals(name, name_size, case_sensitive, hash))
                         return child;
                 return 0;
             }
@@ -981,8 +2864,9 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                std::uint32_t hash = 0;
                 for (xml_node<Ch> *sibling = m_prev_sibling; sibling; sibling = sibling->m_prev_sibling)
-                    if (internal::compare(sibling->name(), sibling->name_size(), name, name_size, case_sensitive))
+                    if (sibling->name_equals(name, name_size, case_sensitive, hash))
                         return sibling;
                 return 0;
             }
@@ -1004,8 +2888,19 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                std::uint32_t hash = 0;
+                if (this->m_parent->valid_child_index() && case_sensitive)
+                {
+                    // Index links siblings with the same name; siblings with other names are looked for only if there are any
+                    if (this->name_equals(name, name_size, true, hash))
+                        return this->m_parent->valid_child_index()->next(this);
+                    if (!hash)
+                        hash = internal::hash(name, name_size);
+                    if (!this->m_parent->valid_child_index()->find(name, name_size, hash)->first)
+                        return 0;
+                }
                 for (xml_node<Ch> *sibling = m_next_sibling; sibling; sibling = sibling->m_next_sibling)
-                    if (internal::compare(sibling->name(), sibling->name_size(), name, name_size, case_sensitive))
+                    if (sibling->name_equals(name, name_size, case_sensitive, hash))
                         return sibling;
                 return 0;
             }
@@ -1013,6 +2908,24 @@ namespace rapidxml
                 return m_next_sibling;
         }
 
+#ifdef RAPIDXML_NAME_SYMBOLS
+        //! Gets next sibling node whose name has given symbol ID.
+        //! Behaviour is undefined if node has no parent.
+        //! Use parent() to test if node has a parent.
+        //! This function is only available if <code>RAPIDXML_NAME_SYMBOLS</code> is defined.
+        //! \param symbol Symbol ID of name, see xml_base::symbol(); must not be 0.
+        //! \return Pointer to found sibling, or 0 if not found.
+        xml_node<Ch> *next_sibling_by_symbol(std::uint32_t symbol) const
+        {
+            assert(this->m_parent);     // Cannot query for siblings if node has no parent
+            assert(symbol);
+            for (xml_node<Ch> *sibling = m_next_sibling; sibling; sibling = sibling->m_next_sibling)
+                if (sibling->m_symbol == symbol)
+                    return sibling;
+            return 0;
+        }
+#endif
+
         //! Gets first attribute of node, optionally matching attribute name.
         //! \param name Name of attribute to find, or 0 to return first attribute regardless of its name; this string doesn't have to be zero-terminated if name_size is non-zero
         //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string
@@ -1024,8 +2937,19 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                std::uint32_t hash = 0;
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+                if (m_attribute_array)
+                {
+                    // Scan the array without following links
+                    for (xml_attribute<Ch> *attribute = m_first_attribute, *end = m_first_attribute + m_attribute_array; attribute != end; ++attribute)
+                        if (attribute->name_equals(name, name_size, case_sensitive, hash))
+                            return attribute;
+                    return 0;
+                }
+#endif
                 for (xml_attribute<Ch> *attribute = m_first_attribute; attribute; attribute = attribute->m_next_attribute)
-                    if (internal::compare(attribute->name(), attribute->name_size(), name, name_size, case_sensitive))
+                    if (attribute->name_equals(name, name_size, case_sensitive, hash))
                         return attribute;
                 return 0;
             }
@@ -1033,6 +2957,67 @@ namespace rapidxml
                 return m_first_attribute;
         }
 
+#ifdef RAPIDXML_NAME_SYMBOLS
+        //! Gets first attribute of node whose name has given symbol ID.
+        //! This function is only available if <code>RAPIDXML_NAME_SYMBOLS</code> is defined.
+        //! \param symbol Symbol ID of name, see xml_base::symbol(); must not be 0.
+        //! \return Pointer to found attribute, or 0 if not found.
+        xml_attribute<Ch> *first_attribute_by_symbol(std::uint32_t symbol) const
+        {
+            assert(symbol);
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+            if (m_attribute_array)
+            {
+                for (xml_attribute<Ch> *attribute = m_first_attribute, *end = m_first_attribute + m_attribute_array; attribute != end; ++attribute)
+                    if (attribute->m_symbol == symbol)
+                        return attribute;
+                return 0;
+            }
+#endif
+            for (xml_attribute<Ch> *attribute = m_first_attribute; attribute; attribute = attribute->m_next_attribute)
+                if (attribute->m_symbol == symbol)
+                    return attribute;
+            return 0;
+        }
+#endif
+
+        //! Gets attribute of node at given position.
+        //! If <code>RAPIDXML_ATTRIBUTE_ARRAYS</code> is defined and attributes of node are stored as contiguous array, 
+        //! see rapidxml::parse_contiguous_attributes, this takes constant time, otherwise attributes are walked from the first one.
+        //! \param index Zero-based position of attribute.
+        //! \return Pointer to attribute, or 0 if node does not have that many attributes.
+        xml_attribute<Ch> *attribute(std::size_t index) const
+        {
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+            if (m_attribute_array)
+                return index < m_attribute_array ? m_first_attribute + index : 0;
+#endif
+            xml_attribute<Ch> *attribute = m_first_attribute;
+            for (; attribute && index > 0; --index)
+                attribute = attribute->m_next_attribute;
+            return attribute;
+        }
+
+        //! Checks if attributes of node are stored as contiguous array.
+        //! This is the case after parsing with rapidxml::parse_contiguous_attributes flag, or after xml_document::compact(),
+        //! until attributes of the node are modified.
+        //! If <code>RAPIDXML_ATTRIBUTE_ARRAYS</code> is defined, this takes constant time;
+        //! otherwise attributes are walked to check that each one follows the previous one in memory.
+        //! \return True if attributes are stored as contiguous array.
+        bool contiguous_attributes() const
+        {
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+            return m_attribute_array != 0;
+#else
+            if (!m_first_attribute)
+                return false;
+            for (xml_attribute<Ch> *attribute = m_first_attribute; attribute->m_next_attribute; attribute = attribute->m_next_attribute)
+                if (attribute->m_next_attribute != attribute + 1)
+                    return false;
+            return true;
+#endif
+        }
+
         //! Gets last attribute of node, optionally matching attribute name.
         //! \param name Name of attribute to find, or 0 to return last attribute regardless of its name; this string doesn't have to be zero-terminated if name_size is non-zero
         //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string
@@ -1044,8 +3029,9 @@ namespace rapidxml
             {
                 if (name_size == 0)
                     name_size = internal::measure(name);
+                std::uint32_t hash = 0;
                 for (xml_attribute<Ch> *attribute = m_last_attribute; attribute; attribute = attribute->m_prev_attribute)
-                    if (internal::compare(attribute->name(), attribute->name_size(), name, name_size, case_sensitive))
+                    if (attribute->name_equals(name, name_size, case_sensitive, hash))
                         return attribute;
                 return 0;
             }
@@ -1055,12 +3041,35 @@ namespace rapidxml
 
         ///////////////////////////////////////////////////////////////////////////
         // Node modification
+
+        using xml_base<Ch>::name;
+
+        //! Sets name of node to a non zero-terminated string, as xml_base::name(const Ch *, std::size_t) does.
+        //! Child index of parent, see memory_pool::index_children(), is discarded, since it maps names of children.
+        //! \param name Name of node to set. Does not have to be zero terminated.
+        //! \param size Size of name, in characters. This does not include zero terminator, if one is present.
+        void name(const Ch *name, std::size_t size)
+        {
+            if (this->m_parent)
+                this->m_parent->discard_child_index();
+            xml_base<Ch>::name(name, size);
+        }
+
+        //! Sets name of node to a zero-terminated string, as xml_base::name(const Ch *) does.
+        //! Child index of parent is discarded, see name(const Ch *, std::size_t).
+        //! \param name Name of node to set. Must be zero terminated.
+        void name(const Ch *name)
+        {
+            this->name(name, internal::measure(name));
+        }
     
         //! Sets type of node.
         //! \param type Type of node to set.
         void type(node_type type)
         {
             m_type = type;
+            if (this->m_parent)
+                this->m_parent->modified();
         }
 
         ///////////////////////////////////////////////////////////////////////////
@@ -1072,6 +3081,8 @@ namespace rapidxml
         void prepend_node(xml_node<Ch> *child)
         {
             assert(child && !child->parent() && child->type() != node_type::node_document);
+            discard_child_index();
+            modified();
             if (first_node())
             {
                 child->m_next_sibling = m_first_node;
@@ -1085,6 +3096,9 @@ namespace rapidxml
             m_first_node = child;
             child->m_parent = this;
             child->m_prev_sibling = 0;
+            m_counts.add_child();
+            if (m_tracked && !child->m_tracked)
+                child->track_subtree();
         }
 
         //! Appends a new child node. 
@@ -1093,19 +3107,9 @@ namespace rapidxml
         void append_node(xml_node<Ch> *child)
         {
             assert(child && !child->parent() && child->type() != node_type::node_document);
-            if (first_node())
-            {
-                child->m_prev_sibling = m_last_node;
-                m_last_node->m_next_sibling = child;
-            }
-            else
-            {
-                child->m_prev_sibling = 0;
-                m_first_node = child;
-            }
-            m_last_node = child;
-            child->m_parent = this;
-            child->m_next_sibling = 0;
+            discard_child_index();
+            modified();
+            link_last_node(child);
         }
 
         //! Inserts a new child node at specified place inside the node. 
@@ -1116,6 +3120,7 @@ namespace rapidxml
         {
             assert(!where || where->parent() == this);
             assert(child && !child->parent() && child->type() != node_type::node_document);
+            discard_child_index();
             if (where == m_first_node)
                 prepend_node(child);
             else if (where == 0)
@@ -1127,6 +3132,10 @@ namespace rapidxml
                 where->m_prev_sibling->m_next_sibling = child;
                 where->m_prev_sibling = child;
                 child->m_parent = this;
+                m_counts.add_child();
+                if (m_tracked && !child->m_tracked)
+                    child->track_subtree();
+                modified();
             }
         }
 
@@ -1136,13 +3145,16 @@ namespace rapidxml
         void remove_first_node()
         {
             assert(first_node());
+            discard_child_index();
             xml_node<Ch> *child = m_first_node;
+            child_removed(child);
             m_first_node = child->m_next_sibling;
             if (child->m_next_sibling)
                 child->m_next_sibling->m_prev_sibling = 0;
             else
                 m_last_node = 0;
             child->m_parent = 0;
+            m_counts.remove_child();
         }
 
         //! Removes last child of the node. 
@@ -1151,7 +3163,9 @@ namespace rapidxml
         void remove_last_node()
         {
             assert(first_node());
+            discard_child_index();
             xml_node<Ch> *child = m_last_node;
+            child_removed(child);
             if (child->m_prev_sibling)
             {
                 m_last_node = child->m_prev_sibling;
@@ -1160,6 +3174,7 @@ namespace rapidxml
             else
                 m_first_node = 0;
             child->m_parent = 0;
+            m_counts.remove_child();
         }
 
         //! Removes specified child from the node
@@ -1168,24 +3183,37 @@ namespace rapidxml
         {
             assert(where && where->parent() == this);
             assert(first_node());
+            discard_child_index();
             if (where == m_first_node)
                 remove_first_node();
             else if (where == m_last_node)
                 remove_last_node();
             else
             {
+                child_removed(where);
                 where->m_prev_sibling->m_next_sibling = where->m_next_sibling;
                 where->m_next_sibling->m_prev_sibling = where->m_prev_sibling;
                 where->m_parent = 0;
+                m_counts.remove_child();
             }
         }
 
         //! Removes all child nodes (but not attributes).
         void remove_all_nodes()
         {
+            discard_child_index();
+            xml_document<Ch, 0> *doc = attached_document();
+            xml_id_index<Ch> *index = doc ? doc->id_index() : 0;
+            if (doc)
+                doc->touch();
             for (xml_node<Ch> *node = first_node(); node; node = node->m_next_sibling)
+            {
+                if (index)
+                    index->erase_tree(node);
                 node->m_parent = 0;
+            }
             m_first_node = 0;
+            m_counts.clear_children();
         }
 
         //! Prepends a new attribute to the node.
@@ -1193,6 +3221,7 @@ namespace rapidxml
         void prepend_attribute(xml_attribute<Ch> *attribute)
         {
             assert(attribute && !attribute->parent());
+            mark_attribute_array(0);
             if (first_attribute())
             {
                 attribute->m_next_attribute = m_first_attribute;
@@ -1206,6 +3235,8 @@ namespace rapidxml
             m_first_attribute = attribute;
             attribute->m_parent = this;
             attribute->m_prev_attribute = 0;
+            m_counts.add_attribute();
+            attribute_added(attribute);
         }
 
         //! Appends a new attribute to the node.
@@ -1213,19 +3244,9 @@ namespace rapidxml
         void append_attribute(xml_attribute<Ch> *attribute)
         {
             assert(attribute && !attribute->parent());
-            if (first_attribute())
-            {
-                attribute->m_prev_attribute = m_last_attribute;
-                m_last_attribute->m_next_attribute = attribute;
-            }
-            else
-            {
-                attribute->m_prev_attribute = 0;
-                m_first_attribute = attribute;
-            }
-            m_last_attribute = attribute;
-            attribute->m_parent = this;
-            attribute->m_next_attribute = 0;
+            mark_attribute_array(0);
+            link_last_attribute(attribute);
+            attribute_added(attribute);
         }
 
         //! Inserts a new attribute at specified place inside the node. 
@@ -1236,6 +3257,7 @@ namespace rapidxml
         {
             assert(!where || where->parent() == this);
             assert(attribute && !attribute->parent());
+            mark_attribute_array(0);
             if (where == m_first_attribute)
                 prepend_attribute(attribute);
             else if (where == 0)
@@ -1247,6 +3269,8 @@ namespace rapidxml
                 where->m_prev_attribute->m_next_attribute = attribute;
                 where->m_prev_attribute = attribute;
                 attribute->m_parent = this;
+                m_counts.add_attribute();
+                attribute_added(attribute);
             }
         }
 
@@ -1256,7 +3280,9 @@ namespace rapidxml
         void remove_first_attribute()
         {
             assert(first_attribute());
+            mark_attribute_array(0);
             xml_attribute<Ch> *attribute = m_first_attribute;
+            attribute_removed(attribute);
             if (attribute->m_next_attribute)
             {
                 attribute->m_next_attribute->m_prev_attribute = 0;
@@ -1265,78 +3291,507 @@ namespace rapidxml
                 m_last_attribute = 0;
             attribute->m_parent = 0;
             m_first_attribute = attribute->m_next_attribute;
+            m_counts.remove_attribute();
+        }
+
+        //! Removes last attribute of the node. 
+        //! If node has no attributes, behaviour is undefined.
+        //! Use first_attribute() to test if node has attributes.
+        void remove_last_attribute()
+        {
+            assert(first_attribute());
+            mark_attribute_array(0);
+            xml_attribute<Ch> *attribute = m_last_attribute;
+            attribute_removed(attribute);
+            if (attribute->m_prev_attribute)
+            {
+                attribute->m_prev_attribute->m_next_attribute = 0;
+                m_last_attribute = attribute->m_prev_attribute;
+            }
+            else
+                m_first_attribute = 0;
+            attribute->m_parent = 0;
+            m_counts.remove_attribute();
+        }
+
+        //! Removes specified attribute from node.
+        //! \param where Pointer to attribute to be removed.
+        void remove_attribute(xml_attribute<Ch> *where)
+        {
+            assert(first_attribute() && where->parent() == this);
+            mark_attribute_array(0);
+            if (where == m_first_attribute)
+                remove_first_attribute();
+            else if (where == m_last_attribute)
+                remove_last_attribute();
+            else
+            {
+                attribute_removed(where);
+                where->m_prev_attribute->m_next_attribute = where->m_next_attribute;
+                where->m_next_attribute->m_prev_attribute = where->m_prev_attribute;
+                where->m_parent = 0;
+                m_counts.remove_attribute();
+            }
+        }
+
+        //! Removes all attributes of node.
+        void remove_all_attributes()
+        {
+            mark_attribute_array(0);
+            xml_document<Ch, 0> *doc = attached_document();
+            xml_id_index<Ch> *index = doc ? doc->id_index() : 0;
+            if (doc)
+                doc->touch();
+            for (xml_attribute<Ch> *attribute = first_attribute(); attribute; attribute = attribute->m_next_attribute)
+            {
+                if (index)
+                    index->erase(attribute);
+                attribute->m_parent = 0;
+            }
+            m_first_attribute = 0;
+            m_counts.clear_attributes();
+        }
+        
+    private:
+
+        friend class xml_base<Ch>;
+
+        // Get document containing the node, which must be notified of changes to the node, or 0 if none or if its updates are deferred.
+        // Detached nodes, including nodes being parsed, are recognized without walking up the tree.
+        // Nodes of documents which do not track changes are recognized without walking up the tree either.
+        xml_document<Ch, 0> *attached_document() const
+        {
+            if (!m_tracked || (!this->m_parent && m_type != node_type::node_document))
+                return 0;
+            xml_document<Ch, 0> *doc = document();
+            return doc && !doc->updates_deferred() ? doc : 0;
+        }
+
+        // Remember number of attributes stored as contiguous array, or 0 if they are only linked
+        void mark_attribute_array(std::size_t count)
+        {
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+            m_attribute_array = count;
+#else
+            (void)count;
+#endif
+        }
+
+        // Get child index, or 0 if children are not indexed or index was discarded
+        internal::child_index<Ch> *valid_child_index() const
+        {
+#ifdef RAPIDXML_CHILD_INDEX
+            return m_child_index && m_child_index->valid ? m_child_index : 0;
+#else
+            return 0;
+#endif
+        }
+
+        // Discard child index after children changed, keeping its memory for memory_pool::index_children()
+        void discard_child_index()
+        {
+#ifdef RAPIDXML_CHILD_INDEX
+            if (m_child_index)
+                m_child_index->valid = false;
+#endif
+        }
+
+        // Link child as last child, without notifying the document; used directly when building new subtrees not attached to any document
+        void link_last_node(xml_node<Ch> *child)
+        {
+            if (first_node())
+            {
+                child->m_prev_sibling = m_last_node;
+                m_last_node->m_next_sibling = child;
+            }
+            else
+            {
+                child->m_prev_sibling = 0;
+                m_first_node = child;
+            }
+            m_last_node = child;
+            child->m_parent = this;
+            child->m_next_sibling = 0;
+            m_counts.add_child();
+            if (m_tracked && !child->m_tracked)
+                child->track_subtree();
+        }
+
+        // Link attribute as last attribute, without notifying the document
+        void link_last_attribute(xml_attribute<Ch> *attribute)
+        {
+            if (first_attribute())
+            {
+                attribute->m_prev_attribute = m_last_attribute;
+                m_last_attribute->m_next_attribute = attribute;
+            }
+            else
+            {
+                attribute->m_prev_attribute = 0;
+                m_first_attribute = attribute;
+            }
+            m_last_attribute = attribute;
+            attribute->m_parent = this;
+            attribute->m_next_attribute = 0;
+            m_counts.add_attribute();
+        }
+
+        // Mark node and its descendants as tracked, see m_tracked; descendants of nodes already tracked are skipped
+        void track_subtree() const
+        {
+            m_tracked = true;
+            const xml_node<Ch> *node = m_first_node;
+            while (node)
+            {
+                if (!node->m_tracked)
+                {
+                    node->m_tracked = true;
+                    if (node->m_first_node)
+                    {
+                        node = node->m_first_node;
+                        continue;
+                    }
+                }
+                while (node != this && !node->m_next_sibling)
+                    node = node->m_parent;
+                node = node == this ? 0 : node->m_next_sibling;
+            }
+        }
+
+        // Advance generation of document containing the node, see xml_document::generation()
+        void modified() const
+        {
+            if (xml_document<Ch, 0> *doc = attached_document())
+                doc->touch();
+        }
+
+        // Update document containing the node after attribute was added to the node
+        void attribute_added(xml_attribute<Ch> *attribute) const
+        {
+            if (xml_document<Ch, 0> *doc = attached_document())
+            {
+                doc->touch();
+                if (xml_id_index<Ch> *index = doc->id_index())
+                    index->insert(attribute);
+            }
+        }
+
+        // Update document containing the node before attribute is removed from the node
+        void attribute_removed(xml_attribute<Ch> *attribute) const
+        {
+            if (xml_document<Ch, 0> *doc = attached_document())
+            {
+                doc->touch();
+                if (xml_id_index<Ch> *index = doc->id_index())
+                    index->erase(attribute);
+            }
+        }
+
+        // Update document containing the node before child is removed from the node, together with its descendants
+        void child_removed(xml_node<Ch> *child) const
+        {
+            if (xml_document<Ch, 0> *doc = attached_document())
+            {
+                doc->touch();
+                if (xml_id_index<Ch> *index = doc->id_index())
+                    index->erase_tree(child);
+            }
+        }
+
+        ///////////////////////////////////////////////////////////////////////////
+        // Restrictions
+
+        // No copying
+        xml_node(const xml_node &);
+        void operator =(const xml_node &);
+    
+        ///////////////////////////////////////////////////////////////////////////
+        // Data members
+    
+        // Note that some of the pointers below have UNDEFINED values if certain other pointers are 0.
+        // This is required for maximum performance, as it allows the parser to omit initialization of 
+        // unneded/redundant values.
+        //
+        // The rules are as follows:
+        // 1. first_node and first_attribute contain valid pointers, or 0 if node has no children/attributes respectively
+        // 2. last_node and last_attribute are valid only if node has at least one child/attribute respectively, otherwise they contain garbage
+        // 3. prev_sibling and next_sibling are valid only if node has a parent, otherwise they contain garbage
+
+        node_type m_type;                       // Type of node; always valid
+        mutable bool m_tracked;                 // Whether changes of the node are reported to document containing it, see xml_document::generation(); if set, it is set for all descendants too
+        internal::node_counts m_counts;         // Numbers of children and attributes, if RAPIDXML_NODE_COUNTS is defined; always valid
+        xml_node<Ch> *m_first_node;             // Pointer to first child node, or 0 if none; always valid
+        xml_node<Ch> *m_last_node;              // Pointer to last child node, or 0 if none; this value is only valid if m_first_node is non-zero
+        xml_attribute<Ch> *m_first_attribute;   // Pointer to first attribute of node, or 0 if none; always valid
+        xml_attribute<Ch> *m_last_attribute;    // Pointer to last attribute of node, or 0 if none; this value is only valid if m_first_attribute is non-zero
+        xml_node<Ch> *m_prev_sibling;           // Pointer to previous sibling of node, or 0 if none; this value is only valid if m_parent is non-zero
+        xml_node<Ch> *m_next_sibling;           // Pointer to next sibling of node, or 0 if none; this value is only valid if m_parent is non-zero
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+        std::size_t m_attribute_array;          // Number of attributes stored as contiguous array starting at m_first_attribute, or 0 if they are only linked; always valid
+#endif
+#ifdef RAPIDXML_CHILD_INDEX
+        internal::child_index<Ch> *m_child_index;   // Hash index of children, which may be discarded, or 0 if none; always valid
+#endif
+#ifdef RAPIDXML_DOCUMENT_ORDER
+        xml_node<Ch> *m_next_in_order;          // Pointer to next node in document order; only valid if document has its nodes linked in document order
+#endif
+
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // ID index
+
+    //! Hash index from values of chosen attributes, such as <code>id</code>, to nodes owning them, similar to getElementById() of DOM.
+    //! Attach the index to a document with xml_document::set_id_index(), and look nodes up with xml_document::element_by_id().
+    //! <br><br>
+    //! Index is kept consistent with attributes of the document:
+    //! attributes are added by the parser if rapidxml::parse_id_index flag is specified, 
+    //! and whenever they are appended, prepended or inserted into a node of the document; 
+    //! they are removed whenever they are removed from their node, or their node or one of its ancestors is removed from its parent.
+    //! Attributes whose values changed are not returned by lookups.
+    //! Attributes of subtrees attached to the document, or renamed or with changed values, are not indexed until rebuild() is called.
+    //! If several nodes have the same value, any one of them is returned.
+    //! <br><br>
+    //! Index memory is allocated from a memory resource rather than document pool, 
+    //! so that index and its attribute names survive xml_document::clear(); entries are cleared by it, and by each parse.
+    //! \param Ch Character type to use.
+    template<class Ch = char>
+    class xml_id_index
+    {
+
+    public:
+
+        //! Maximum number of attribute names an index can track.
+        static const std::size_t max_names = 8;
+
+        //! Constructs empty index, with no attribute names.
+        //! \param resource Memory resource to allocate memory of the index from, or 0 to use global <code>new</code> and <code>delete</code>.
+        explicit xml_id_index(std::pmr::memory_resource *resource = 0)
+            : m_resource(resource ? resource : std::pmr::new_delete_resource())
+            , m_name_count(0)
+            , m_entries(0)
+            , m_slot_count(0)
+            , m_count(0)
+            , m_used(0)
+        {
+        }
+
+        //! Destroys index and frees its memory.
+        ~xml_id_index()
+        {
+            release();
+        }
+
+        //! Adds name of attribute whose values are indexed.
+        //! Index only refers to the name, which must persist for the lifetime of the index.
+        //! Add names before parsing; attributes already in the document are indexed by rebuild().
+        //! \param name Name of attribute; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of name, in characters, or 0 to have size calculated automatically from string.
+        void add_attribute_name(const Ch *name, std::size_t size = 0)
+        {
+            assert(m_name_count < max_names);
+            m_names[m_name_count] = name;
+            m_name_sizes[m_name_count] = size ? size : internal::measure(name);
+            ++m_name_count;
+        }
+
+        //! Checks if attributes with given name are indexed.
+        //! \param name Name of attribute; this string doesn't have to be zero-terminated.
+        //! \param size Size of name, in characters.
+        //! \return True if name was added with add_attribute_name().
+        bool indexes(const Ch *name, std::size_t size) const
+        {
+            for (std::size_t i = 0; i < m_name_count; ++i)
+                if (internal::compare(m_names[i], m_name_sizes[i], name, size, true))
+                    return true;
+            return false;
+        }
+
+        //! Adds attribute to the index, if its name is indexed.
+        //! This is done automatically for attributes of the document the index is attached to.
+        //! \param attribute Attribute to add.
+        void insert(xml_attribute<Ch> *attribute)
+        {
+            if (!indexes(attribute->name(), attribute->name_size()))
+                return;
+            if (2 * (m_used + 1) > m_slot_count)
+                rehash();
+            std::uint32_t hash = internal::hash(attribute->value(), attribute->value_size());
+            std::size_t mask = m_slot_count - 1;
+            std::size_t slot = hash & mask;
+            while (m_entries[slot].attribute)
+                slot = (slot + 1) & mask;
+            if (!m_entries[slot].hash)
+                ++m_used;       // Slot was never used, rather than holding a removed entry
+            m_entries[slot].attribute = attribute;
+            m_entries[slot].hash = hash;
+            ++m_count;
+        }
+
+        //! Removes attribute from the index, if present.
+        //! This is done automatically for attributes of the document the index is attached to.
+        //! \param attribute Attribute to remove; its value must be the same as when it was added.
+        void erase(xml_attribute<Ch> *attribute)
+        {
+            if (m_count == 0 || !indexes(attribute->name(), attribute->name_size()))
+                return;
+            std::uint32_t hash = internal::hash(attribute->value(), attribute->value_size());
+            std::size_t mask = m_slot_count - 1;
+            for (std::size_t slot = hash & mask; m_entries[slot].hash; slot = (slot + 1) & mask)
+                if (m_entries[slot].attribute == attribute)
+                {
+                    m_entries[slot].attribute = 0;      // Nonzero hash marks removed entry
+                    --m_count;
+                    return;
+                }
+        }
+
+        //! Finds node owning an indexed attribute with given value, which belongs to given document.
+        //! Use xml_document::element_by_id() instead, which passes the document.
+        //! \param value Value to find; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of value, in characters, or 0 to have size calculated automatically from string.
+        //! \param document Document the node must belong to.
+        //! \return Pointer to found node, or 0 if not found.
+        xml_node<Ch> *find(const Ch *value, std::size_t size, const xml_document<Ch, 0> *document) const
+        {
+            if (m_count == 0)
+                return 0;
+            if (size == 0)
+                size = internal::measure(value);
+            std::uint32_t hash = internal::hash(value, size);
+            std::size_t mask = m_slot_count - 1;
+            for (std::size_t slot = hash & mask; m_entries[slot].hash; slot = (slot + 1) & mask)
+            {
+                xml_attribute<Ch> *attribute = m_entries[slot].attribute;
+                if (attribute && m_entries[slot].hash == hash &&
+                    internal::compare(attribute->value(), attribute->value_size(), value, size, true) &&
+                    indexes(attribute->name(), attribute->name_size()) && 
+                    attribute->document() == document)
+                    return attribute->parent();
+            }
+            return 0;
+        }
+
+        //! Removes all attributes of a tree from the index.
+        //! This is done automatically for nodes removed from the document the index is attached to.
+        //! Takes time proportional to size of the tree, unless the index is empty.
+        //! \param root Root of the tree; its attributes are removed as well.
+        void erase_tree(xml_node<Ch> *root)
+        {
+            if (m_count == 0)
+                return;
+            for (xml_node<Ch> *node = root; node; )
+            {
+                for (xml_attribute<Ch> *attribute = node->first_attribute(); attribute; attribute = attribute->next_attribute())
+                    erase(attribute);
+
+                // Advance to next node in document order
+                if (node->first_node())
+                    node = node->first_node();
+                else
+                {
+                    while (node != root && !node->next_sibling())
+                        node = node->parent();
+                    node = node == root ? 0 : node->next_sibling();
+                }
+            }
         }
 
-        //! Removes last attribute of the node. 
-        //! If node has no attributes, behaviour is undefined.
-        //! Use first_attribute() to test if node has attributes.
-        void remove_last_attribute()
+        //! Removes all entries, and adds all indexed attributes of a tree.
+        //! \param root Root of the tree, normally the document.
+        void rebuild(xml_node<Ch> *root)
         {
-            assert(first_attribute());
-            xml_attribute<Ch> *attribute = m_last_attribute;
-            if (attribute->m_prev_attribute)
+            clear();
+            for (xml_node<Ch> *node = root; node; )
             {
-                attribute->m_prev_attribute->m_next_attribute = 0;
-                m_last_attribute = attribute->m_prev_attribute;
+                for (xml_attribute<Ch> *attribute = node->first_attribute(); attribute; attribute = attribute->next_attribute())
+                    insert(attribute);
+
+                // Advance to next node in document order
+                if (node->first_node())
+                    node = node->first_node();
+                else
+                {
+                    while (node != root && !node->next_sibling())
+                        node = node->parent();
+                    node = node == root ? 0 : node->next_sibling();
+                }
             }
-            else
-                m_first_attribute = 0;
-            attribute->m_parent = 0;
         }
 
-        //! Removes specified attribute from node.
-        //! \param where Pointer to attribute to be removed.
-        void remove_attribute(xml_attribute<Ch> *where)
+        //! Removes all entries, keeping attribute names.
+        void clear()
         {
-            assert(first_attribute() && where->parent() == this);
-            if (where == m_first_attribute)
-                remove_first_attribute();
-            else if (where == m_last_attribute)
-                remove_last_attribute();
-            else
+            for (std::size_t slot = 0; slot < m_slot_count; ++slot)
             {
-                where->m_prev_attribute->m_next_attribute = where->m_next_attribute;
-                where->m_next_attribute->m_prev_attribute = where->m_prev_attribute;
-                where->m_parent = 0;
+                m_entries[slot].attribute = 0;
+                m_entries[slot].hash = 0;
             }
+            m_count = 0;
+            m_used = 0;
         }
 
-        //! Removes all attributes of node.
-        void remove_all_attributes()
+        //! Gets number of attributes in the index.
+        //! \return Number of attributes.
+        std::size_t size() const
         {
-            for (xml_attribute<Ch> *attribute = first_attribute(); attribute; attribute = attribute->m_next_attribute)
-                attribute->m_parent = 0;
-            m_first_attribute = 0;
+            return m_count;
         }
-        
+
     private:
 
-        ///////////////////////////////////////////////////////////////////////////
-        // Restrictions
+        struct entry
+        {
+            xml_attribute<Ch> *attribute;           // Indexed attribute, or 0 if slot is empty or entry was removed
+            std::uint32_t hash;                     // Hash of value, or 0 if slot was never used
+        };
 
         // No copying
-        xml_node(const xml_node &);
-        void operator =(const xml_node &);
-    
-        ///////////////////////////////////////////////////////////////////////////
-        // Data members
-    
-        // Note that some of the pointers below have UNDEFINED values if certain other pointers are 0.
-        // This is required for maximum performance, as it allows the parser to omit initialization of 
-        // unneded/redundant values.
-        //
-        // The rules are as follows:
-        // 1. first_node and first_attribute contain valid pointers, or 0 if node has no children/attributes respectively
-        // 2. last_node and last_attribute are valid only if node has at least one child/attribute respectively, otherwise they contain garbage
-        // 3. prev_sibling and next_sibling are valid only if node has a parent, otherwise they contain garbage
+        xml_id_index(const xml_id_index &);
+        void operator =(const xml_id_index &);
 
-        node_type m_type;                       // Type of node; always valid
-        xml_node<Ch> *m_first_node;             // Pointer to first child node, or 0 if none; always valid
-        xml_node<Ch> *m_last_node;              // Pointer to last child node, or 0 if none; this value is only valid if m_first_node is non-zero
-        xml_attribute<Ch> *m_first_attribute;   // Pointer to first attribute of node, or 0 if none; always valid
-        xml_attribute<Ch> *m_last_attribute;    // Pointer to last attribute of node, or 0 if none; this value is only valid if m_first_attribute is non-zero
-        xml_node<Ch> *m_prev_sibling;           // Pointer to previous sibling of node, or 0 if none; this value is only valid if m_parent is non-zero
-        xml_node<Ch> *m_next_sibling;           // Pointer to next sibling of node, or 0 if none; this value is only valid if m_parent is non-zero
+        // Reallocate slots, dropping removed entries, and doubling their number if more than a quarter is taken by live entries
+        void rehash()
+        {
+            std::size_t slot_count = m_slot_count ? m_slot_count : 64;
+            if (4 * (m_count + 1) > slot_count)
+                slot_count *= 2;
+            entry *entries = static_cast<entry *>(m_resource->allocate(slot_count * sizeof(entry), alignof(entry)));
+            for (std::size_t slot = 0; slot < slot_count; ++slot)
+            {
+                entries[slot].attribute = 0;
+                entries[slot].hash = 0;
+            }
+            for (std::size_t i = 0; i < m_slot_count; ++i)
+                if (m_entries[i].attribute)
+                {
+                    std::size_t slot = m_entries[i].hash & (slot_count - 1);
+                    while (entries[slot].hash)
+                        slot = (slot + 1) & (slot_count - 1);
+                    entries[slot] = m_entries[i];
+                }
+            release();
+            m_entries = entries;
+            m_slot_count = slot_count;
+            m_used = m_count;
+        }
+
+        void release()
+        {
+            if (m_entries)
+                m_resource->deallocate(m_entries, m_slot_count * sizeof(entry), alignof(entry));
+            m_entries = 0;
+            m_slot_count = 0;
+        }
+
+        std::pmr::memory_resource *m_resource;      // Resource for entries
+        const Ch *m_names[max_names];               // Names of indexed attributes
+        std::size_t m_name_sizes[max_names];        // Sizes of names of indexed attributes
+        std::size_t m_name_count;                   // Number of names of indexed attributes
+        entry *m_entries;                           // Open addressing hash table of attributes, keyed by value
+        std::size_t m_slot_count;                   // Number of slots, a power of 2, or 0 if none
+        std::size_t m_count;                        // Number of attributes in the index
+        std::size_t m_used;                         // Number of slots holding attributes or removed entries
 
     };
 
@@ -1345,21 +3800,197 @@ namespace rapidxml
     
     //! This class represents root of the DOM hierarchy. 
     //! It is also an xml_node and a memory_pool through public inheritance.
+    //! Document embeds <code>StaticSize</code> bytes of static memory, by default <code>RAPIDXML_STATIC_POOL_SIZE</code>,
+    //! which its memory pool uses before allocating any dynamic memory;
+    //! pass a buffer, or no buffer at all, to the constructor to use other static memory instead.
+    //! Documents with <code>StaticSize</code> of 0 embed no memory at all, so that they take only a few hundred bytes,
+    //! which suits many small documents, or documents stored in containers.
+    //! Every document is also an <code>xml_document<Ch, 0></code>, which is the type of document returned by xml_node::document().
+    //! Document can be moved, but not copied; moving takes over its nodes and memory without copying them,
+    //! except for nodes allocated from embedded static memory, which are copied out of it first.
     //! Use parse() function to build a DOM tree from a zero-terminated XML text string.
     //! parse() function allocates memory for nodes and attributes by using functions of xml_document, 
     //! which are inherited from memory_pool.
     //! To access root node of the document, use the document itself, as if it was an xml_node.
     //! \param Ch Character type to use.
-    template<class Ch = char>
-    class xml_document: public xml_node<Ch>, public memory_pool<Ch>
+    //! \param StaticSize Size of embedded static memory, in bytes, or 0 to embed none.
+    template<class Ch, std::size_t StaticSize>
+    class xml_document: public xml_document<Ch, 0>
+    {
+
+    public:
+
+        //! Constructs empty XML document using embedded static memory.
+        xml_document()
+            : xml_document<Ch, 0>(m_static_buffer, StaticSize)
+        {
+            this->embed(m_static_buffer, StaticSize);
+        }
+
+        //! Constructs empty XML document using embedded static memory, whose memory pool allocates dynamic blocks from a memory resource.
+        //! See memory_pool::set_memory_resource().
+        //! \param resource Memory resource, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        explicit xml_document(std::pmr::memory_resource *resource)
+            : xml_document<Ch, 0>(m_static_buffer, StaticSize, resource)
+        {
+            this->embed(m_static_buffer, StaticSize);
+        }
+
+        //! Constructs empty XML document whose memory pool starts with caller-supplied static memory instead of embedded static memory, which is left unused.
+        //! See xml_document<Ch, 0>::xml_document(char *, std::size_t, std::pmr::memory_resource *).
+        //! \param buffer Static memory to use, or 0 to allocate dynamic memory only. It must outlive the document.
+        //! \param size Size of static memory, in bytes.
+        //! \param resource Memory resource, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        xml_document(char *buffer, std::size_t size, std::pmr::memory_resource *resource = 0)
+            : xml_document<Ch, 0>(buffer, size, resource)
+        {
+            this->embed(m_static_buffer, StaticSize);
+        }
+
+        //! Constructs document which takes over tree, memory pool and settings of another document, 
+        //! see xml_document<Ch, 0>::xml_document(xml_document<Ch, 0> &&).
+        //! \param other Document to move from.
+        xml_document(xml_document &&other)
+            : xml_document<Ch, 0>(static_cast<xml_document<Ch, 0> &&>(other))
+        {
+            this->embed(m_static_buffer, StaticSize);
+            if (other.uses_embedded_memory())
+                this->use_embedded_memory();
+        }
+
+        //! Clears the document, and takes over tree, memory pool and settings of another document, as the move constructor does.
+        //! \param other Document to move from.
+        //! \return Reference to this document.
+        xml_document &operator =(xml_document &&other)
+        {
+            xml_document<Ch, 0>::operator =(static_cast<xml_document<Ch, 0> &&>(other));
+            return *this;
+        }
+
+    private:
+
+        char m_static_buffer[StaticSize];   // Embedded static memory, used by memory_pool unless constructed with a caller-supplied buffer
+
+    };
+
+    //! Document without embedded static memory, and common base of all documents.
+    //! See xml_document for description.
+    //! \param Ch Character type to use.
+    template<class Ch>
+    class xml_document<Ch, 0>: public xml_node<Ch>, public memory_pool<Ch>
     {
     
     public:
 
-        //! Constructs empty XML document
+        //! Constructs empty XML document without static memory.
         xml_document()
             : xml_node<Ch>(node_type::node_document)
+            , m_symbols(0)
+            , m_vocabulary(0)
+            , m_classify(0)
+            , m_id_index(0)
+            , m_generation(0)
+            , m_order_tail(0)
+            , m_order_generation(0)
+            , m_order_linked(false)
+            , m_updates_deferred(false)
+            , m_embedded_memory(0)
+            , m_embedded_size(0)
+            , m_embedded_released(false)
+        {
+        }
+
+        //! Constructs empty XML document without static memory, whose memory pool allocates dynamic blocks from a memory resource.
+        //! See memory_pool::set_memory_resource().
+        //! \param resource Memory resource, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        explicit xml_document(std::pmr::memory_resource *resource)
+            : xml_node<Ch>(node_type::node_document)
+            , memory_pool<Ch>(resource)
+            , m_symbols(0)
+            , m_vocabulary(0)
+            , m_classify(0)
+            , m_id_index(0)
+            , m_generation(0)
+            , m_order_tail(0)
+            , m_order_generation(0)
+            , m_order_linked(false)
+            , m_updates_deferred(false)
+            , m_embedded_memory(0)
+            , m_embedded_size(0)
+            , m_embedded_released(false)
+        {
+        }
+
+        //! Constructs empty XML document whose memory pool starts with caller-supplied static memory.
+        //! Documents constructed this way can be moved, see xml_document(xml_document &&).
+        //! See memory_pool::set_static_memory().
+        //! \param buffer Static memory to use, or 0 to allocate dynamic memory only. It must outlive the document.
+        //! \param size Size of static memory, in bytes.
+        //! \param resource Memory resource, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        xml_document(char *buffer, std::size_t size, std::pmr::memory_resource *resource = 0)
+            : xml_node<Ch>(node_type::node_document)
+            , memory_pool<Ch>(buffer, size, resource)
+            , m_symbols(0)
+            , m_vocabulary(0)
+            , m_classify(0)
+            , m_id_index(0)
+            , m_generation(0)
+            , m_order_tail(0)
+            , m_order_generation(0)
+            , m_order_linked(false)
+            , m_updates_deferred(false)
+            , m_embedded_memory(0)
+            , m_embedded_size(0)
+            , m_embedded_released(false)
+        {
+        }
+
+        //! Constructs document which takes over tree, memory pool and settings of another document, 
+        //! including its symbol table, vocabulary and ID index.
+        //! Nodes, attributes and strings are not copied, so pointers to them remain valid, and only children and attributes of the document itself are updated;
+        //! this takes constant time for documents with a single root element.
+        //! Documents can thus be returned by value and stored in containers.
+        //! Caller-supplied static memory of the other document is taken over as well, and must outlive this document.
+        //! Static memory embedded in the other document cannot be taken over; if anything was allocated from it,
+        //! the tree of the other document is first copied out of it to dynamic memory, as by compact(),
+        //! so that pointers to its nodes, attributes and strings obtained before the move are no longer valid.
+        //! Construct documents with a caller-supplied buffer, or none, or use xml_document<Ch, 0>, to have them moved without copying.
+        //! Each document then keeps using its own embedded static memory, if it has any.
+        //! The other document is left empty, as if cleared, and can be reused.
+        //! \param other Document to move from.
+        xml_document(xml_document &&other)
+            : xml_node<Ch>(node_type::node_document)
+            , memory_pool<Ch>(static_cast<memory_pool<Ch> &&>(other.release_embedded_memory()))
+            , m_symbols(0)
+            , m_vocabulary(0)
+            , m_classify(0)
+            , m_id_index(0)
+            , m_generation(0)
+            , m_order_tail(0)
+            , m_order_generation(0)
+            , m_order_linked(false)
+            , m_updates_deferred(false)
+            , m_embedded_memory(0)
+            , m_embedded_size(0)
+            , m_embedded_released(false)
+        {
+            take_tree(other);
+        }
+
+        //! Clears the document, and takes over tree, memory pool and settings of another document, as the move constructor does.
+        //! Generation of the document is advanced, see generation().
+        //! \param other Document to move from.
+        //! \return Reference to this document.
+        xml_document &operator =(xml_document &&other)
         {
+            if (this != &other)
+            {
+                if (m_id_index)
+                    m_id_index->clear();
+                memory_pool<Ch>::operator =(static_cast<memory_pool<Ch> &&>(other.release_embedded_memory()));
+                take_tree(other);
+            }
+            return *this;
         }
 
         //! Parses zero-terminated XML string according to given flags.
@@ -1377,10 +4008,19 @@ namespace rapidxml
         void parse(Ch *text)
         {
             assert(text);
+#ifndef RAPIDXML_NAME_SYMBOLS
+            static_assert(!(Flags & (parse_intern_names | internal::parse_vocabulary)), "RAPIDXML_NAME_SYMBOLS must be defined to intern or classify names");
+#endif
+            assert(!(Flags & parse_intern_names) || m_symbols);    // Symbol table is required to intern names
+            assert(!(Flags & parse_id_index) || m_id_index);       // ID index is required to index attributes
             
-            // Remove current contents
+            // Remove current contents, clearing index first so that entries are not erased one by one
+            if (m_id_index)
+                m_id_index->clear();
             this->remove_all_nodes();
             this->remove_all_attributes();
+            m_order_linked = false;
+            m_order_tail = this;
             
             // Parse BOM, if any
             parse_bom<Flags>(text);
@@ -1404,17 +4044,373 @@ namespace rapidxml
                     RAPIDXML_PARSE_ERROR("expected <", text);
             }
 
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            // Terminate links in document order
+            if (Flags & parse_document_order)
+            {
+                m_order_tail->m_next_in_order = 0;
+                m_order_linked = true;
+                m_order_generation = m_generation;
+                if (!this->m_tracked)
+                    this->track_subtree();
+            }
+#endif
+        }
+
+        //! Parses zero-terminated XML string according to given flags, like parse(Ch *), classifying names with a vocabulary known at compile time.
+        //! Each element and attribute name found in the vocabulary gets its position in the vocabulary as symbol ID, 
+        //! all other names get symbol ID 0; see xml_base::symbol().
+        //! Name hashes are stored as well, as if rapidxml::parse_name_hashes was specified.
+        //! Classification performs no allocations, and vocabulary is not used after the call.
+        //! This function requires <code>RAPIDXML_NAME_SYMBOLS</code> to be defined.
+        //! \param text XML data to parse; pointer is non-const to denote fact that this data may be modified by the parser.
+        //! \param vocabulary Vocabulary of names, see xml_vocabulary.
+        template<int Flags, std::size_t N>
+        void parse(Ch *text, const xml_vocabulary<Ch, N> &vocabulary)
+        {
+            static_assert(!(Flags & parse_intern_names), "Names cannot be both interned and classified with a vocabulary");
+
+            // Forget the vocabulary when parsing ends, even with an error, so that it is not referred to after the call
+            struct vocabulary_scope
+            {
+                xml_document *document;
+                ~vocabulary_scope()
+                {
+                    document->m_vocabulary = 0;
+                    document->m_classify = 0;
+                }
+            } scope = { this };
+            m_vocabulary = &vocabulary;
+            m_classify = &classify<N>;
+            parse<Flags | internal::parse_vocabulary>(text);
         }
 
         //! Clears the document by deleting all nodes and clearing the memory pool.
         //! All nodes owned by document pool are destroyed.
         void clear()
         {
+            if (m_id_index)
+                m_id_index->clear();
             this->remove_all_nodes();
             this->remove_all_attributes();
             memory_pool<Ch>::clear();
         }
+
+        //! Compacts the document after heavy editing.
+        //! All nodes and attributes reachable from the document, together with their names and values, 
+        //! are copied in document order to a new block of the memory pool, which is exactly as large as needed.
+        //! Nodes are placed first, followed by attributes and then strings, so that traversal of the tree touches as little memory as possible;
+        //! if pool uses segregated arenas, each of them gets its own new block.
+        //! All other memory of the pool, holding removed nodes, freed nodes, old strings and other dead data, is then released.
+        //! Static memory of the pool is left unused until clear() is called.
+        //! <br><br>
+        //! This restores both memory footprint and locality of traversal. 
+        //! Since names and values are copied too, after compaction the document no longer refers to source text passed to parse(), 
+        //! or to any other strings not allocated from its pool.
+        //! <br><br>
+        //! Any pointers to nodes, attributes or strings of the document obtained before the call are no longer valid.
+        //! This includes nodes allocated from the document pool, but not attached to the document.
+        void compact()
+        {
+            this->compact_tree(this, layout_depth_first);
+            touch();
+            if (m_id_index)
+                m_id_index->rebuild(this);
+        }
+
+        //! Rewrites storage of the document so that nodes are placed in memory in order chosen for the expected access pattern.
+        //! This is intended to be called once, after parse() and any editing, on documents which are then only read, many times.
+        //! The document is compacted like by compact(), except that nodes are copied in order given by layout flags,
+        //! and attributes and strings follow the order of their nodes.
+        //! Links between nodes are unchanged, so that the document keeps its content and can still be navigated and modified as usual.
+        //! <br><br>
+        //! Any pointers to nodes, attributes or strings of the document obtained before the call are no longer valid,
+        //! as with compact().
+        //! \param layout Layout flags, one of rapidxml::layout_depth_first, rapidxml::layout_breadth_first or rapidxml::layout_blocked, 
+        //! optionally combined with rapidxml::layout_inline_children.
+        void relayout(int layout)
+        {
+            this->compact_tree(this, layout);
+            touch();
+            if (m_id_index)
+                m_id_index->rebuild(this);
+        }
+
+        //! Takes ownership of all memory of another document, together with all nodes, attributes and strings allocated from it, 
+        //! like memory_pool::adopt() does for pools.
+        //! Static memory of the other document, embedded or caller-supplied, is not owned by its pool, so it cannot be adopted;
+        //! if anything was allocated from it, the tree of the other document is first copied out of it to dynamic memory, as by compact().
+        //! Any pointers to nodes, attributes or strings of the other document obtained before the call are then no longer valid,
+        //! so get subtrees to move from the other document after the call.
+        //! The other document keeps its static memory and its tree, whose memory now belongs to this document.
+        //! \param other Document whose memory to adopt.
+        void adopt(xml_document &other)
+        {
+            char *buffer = other.m_static_memory;
+            std::size_t size = other.m_static_size;
+            if (buffer)
+            {
+                if (other.static_memory_used())
+                    other.compact();
+                other.detach_static_memory();
+            }
+            memory_pool<Ch>::adopt(other);
+            if (buffer)
+                other.attach_static_memory(buffer, size);
+        }
+
+        using memory_pool<Ch>::adopt;
+
+        //! Clones a node with its attributes and descendants into memory of the document, as memory_pool::deep_clone() does,
+        //! interning names of the clone in symbol table of the document if source belongs to another symbol table.
+        //! \param source Node to clone; it must not be a document.
+        //! \return Pointer to cloned node, which has no parent. This pointer will never be NULL.
+        xml_node<Ch> *deep_clone(const xml_node<Ch> *source)
+        {
+            return memory_pool<Ch>::deep_clone(source, m_symbols);
+        }
+
+        //! Sets symbol table used to intern names when parsing with rapidxml::parse_intern_names flag.
+        //! The same table can be set for many documents, so that equal names get equal symbol IDs in all of them.
+        //! Document does not own the table; it must outlive any use of symbol IDs of the document.
+        //! \param table Symbol table, or 0 to remove the table.
+        void set_symbol_table(xml_symbol_table<Ch> *table)
+        {
+            m_symbols = table;
+        }
+
+        //! Gets symbol table of the document.
+        //! \return Symbol table set by set_symbol_table(), or 0 if none.
+        xml_symbol_table<Ch> *symbol_table() const
+        {
+            return m_symbols;
+        }
+
+        //! Gets generation of the document, which changes whenever the document is modified,
+        //! so that results computed from the document, such as cached query results, can be checked for validity.
+        //! Generation is advanced by parse(), clear(), compact() and relayout(),
+        //! and by functions of xml_node and xml_base which change children, attributes, names, values or types of nodes of the document.
+        //! Changes to nodes not attached to the document do not advance it until the nodes are attached.
+        //! Strings modified in place are not detected; call touch() after modifying them.
+        //! <br><br>
+        //! Functions of nodes report changes to the document only once it tracks them, 
+        //! which it starts doing when its generation is first read, when it gets an ID index, or when its nodes are linked in document order.
+        //! Until then, modifying nodes costs nothing beyond the modification itself; 
+        //! starting to track takes time proportional to size of the document, once.
+        //! \return Generation of the document.
+        std::size_t generation() const
+        {
+            if (!this->m_tracked)
+                this->track_subtree();
+            return m_generation;
+        }
+
+        //! Checks if nodes of the document are linked in document order, see xml_node::next_in_document_order().
+        //! Links are made by parse() with rapidxml::parse_document_order flag, or by link_document_order(),
+        //! and become invalid when generation of the document changes.
+        //! \return True if links are valid.
+        bool document_order_linked() const
+        {
+            return m_order_linked && m_order_generation == m_generation;
+        }
+
+        //! Links all nodes of the document in document order, see xml_node::next_in_document_order().
+        //! Use it to restore links after modifying the document.
+        //! This function does nothing unless <code>RAPIDXML_DOCUMENT_ORDER</code> is defined.
+        void link_document_order()
+        {
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            xml_node<Ch> *tail = this;
+            for (xml_node<Ch> *node = this->first_node(); node; )
+            {
+                tail->m_next_in_order = node;
+                tail = node;
+                if (node->first_node())
+                    node = node->first_node();
+                else
+                {
+                    while (node != this && !node->next_sibling())
+                        node = node->parent();
+                    node = node == this ? 0 : node->next_sibling();
+                }
+            }
+            tail->m_next_in_order = 0;
+            m_order_linked = true;
+            m_order_generation = m_generation;
+            if (!this->m_tracked)
+                this->track_subtree();
+#endif
+        }
+
+        //! Advances generation of the document, see generation().
+        void touch()
+        {
+            ++m_generation;
+        }
+
+        //! Defers or resumes updates which modifications of nodes of the document make to the document itself:
+        //! advancing its generation, and keeping its ID index consistent.
+        //! While updates are deferred, different subtrees of the document can be modified by different threads at once,
+        //! as rapidxml::parallel_transform() does.
+        //! When updates are resumed, generation is advanced, and ID index is rebuilt if the document has one.
+        //! \param defer True to defer updates, false to resume them.
+        void defer_updates(bool defer)
+        {
+            m_updates_deferred = defer;
+            if (!defer)
+            {
+                touch();
+                if (m_id_index)
+                    m_id_index->rebuild(this);
+            }
+        }
+
+        //! Checks if updates of the document are deferred, see defer_updates().
+        //! \return True if updates are deferred.
+        bool updates_deferred() const
+        {
+            return m_updates_deferred;
+        }
+
+        //! Sets ID index of the document, which maps values of chosen attributes to their nodes; see xml_id_index.
+        //! Attributes already in the document are added to the index.
+        //! Document does not own the index, and an index can be set for one document at a time.
+        //! \param index ID index, or 0 to remove the index.
+        void set_id_index(xml_id_index<Ch> *index)
+        {
+            m_id_index = index;
+            if (index)
+            {
+                if (!this->m_tracked)
+                    this->track_subtree();
+                index->rebuild(this);
+            }
+        }
+
+        //! Gets ID index of the document.
+        //! \return ID index set by set_id_index(), or 0 if none.
+        xml_id_index<Ch> *id_index() const
+        {
+            return m_id_index;
+        }
+
+        //! Finds node of the document which has an attribute indexed by ID index of the document with given value.
+        //! Lookup takes constant time, irrespective of size of the document.
+        //! \param value Value to find; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of value, in characters, or 0 to have size calculated automatically from string.
+        //! \return Pointer to found node, or 0 if not found or if document has no ID index.
+        xml_node<Ch> *element_by_id(const Ch *value, std::size_t size = 0) const
+        {
+            return m_id_index ? m_id_index->find(value, size, this) : 0;
+        }
         
+    private:
+
+        // Take over tree and settings of other document, whose memory pool was already taken over, leaving it empty
+        void take_tree(xml_document &other)
+        {
+            // Both documents use their own embedded static memory if the other document did
+            if (other.m_embedded_released)
+            {
+                other.m_embedded_released = false;
+                other.use_embedded_memory();
+                use_embedded_memory();
+            }
+            bool linked = other.document_order_linked();
+            this->m_name = other.m_name;
+            this->m_name_size = other.m_name_size;
+            this->m_value = other.m_value;
+            this->m_value_size = other.m_value_size;
+            this->name_hash(other.name_hash());
+            this->copy_symbol(&other);
+            this->m_first_node = other.m_first_node;
+            this->m_last_node = other.m_last_node;
+            this->m_first_attribute = other.m_first_attribute;
+            this->m_last_attribute = other.m_last_attribute;
+#ifdef RAPIDXML_ATTRIBUTE_ARRAYS
+            this->m_attribute_array = other.m_attribute_array;
+#endif
+#ifdef RAPIDXML_CHILD_INDEX
+            this->m_child_index = other.m_child_index;
+#endif
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            this->m_next_in_order = other.m_next_in_order;
+#endif
+            this->m_counts = other.m_counts;
+            for (xml_node<Ch> *child = this->m_first_node; child; child = child->m_next_sibling)
+                child->m_parent = this;
+            for (xml_attribute<Ch> *attribute = this->m_first_attribute; attribute; attribute = attribute->next_attribute())
+                attribute->m_parent = this;
+            m_symbols = other.m_symbols;
+            m_id_index = other.m_id_index;
+            m_generation = (m_generation > other.m_generation ? m_generation : other.m_generation) + 1;
+            m_order_tail = other.m_order_tail == &other ? this : other.m_order_tail;
+            m_order_generation = m_generation;
+            m_order_linked = linked;
+            m_updates_deferred = other.m_updates_deferred;
+            if (this->m_tracked || other.m_tracked)
+                this->track_subtree();
+
+            // Leave other document empty, advancing its generation so that results computed from it become invalid
+            other.m_name = 0;
+            other.m_value = 0;
+            other.name_hash(0);
+            other.symbol(0);
+            other.m_first_node = 0;
+            other.m_first_attribute = 0;
+            other.mark_attribute_array(0);
+#ifdef RAPIDXML_CHILD_INDEX
+            other.m_child_index = 0;
+#endif
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            other.m_next_in_order = 0;
+#endif
+            other.m_counts = internal::node_counts();
+            other.m_symbols = 0;
+            other.m_id_index = 0;
+            other.m_order_tail = 0;
+            other.m_order_linked = false;
+            other.m_updates_deferred = false;
+            other.touch();
+        }
+
+        // Detach embedded static memory from the pool, so that the pool can be taken over, copying the tree out of it first if anything was allocated from it
+        xml_document &release_embedded_memory()
+        {
+            if (uses_embedded_memory())
+            {
+                if (this->static_memory_used())
+                    compact();
+                this->detach_static_memory();
+                m_embedded_released = true;
+            }
+            return *this;
+        }
+
+    protected:
+
+        //! \cond internal
+        // Record static memory embedded in derived document, which is static memory of the pool unless caller supplied other
+        void embed(char *buffer, std::size_t size)
+        {
+            m_embedded_memory = buffer;
+            m_embedded_size = size;
+        }
+
+        // Check if pool uses embedded static memory
+        bool uses_embedded_memory() const
+        {
+            return m_embedded_memory && this->m_static_memory == m_embedded_memory;
+        }
+
+        // Make embedded static memory, if any, static memory of the pool, unless pool uses other static memory
+        void use_embedded_memory()
+        {
+            if (m_embedded_memory && !this->m_static_memory)
+                this->attach_static_memory(m_embedded_memory, m_embedded_size);
+        }
+        //! \endcond
+
     private:
 
         ///////////////////////////////////////////////////////////////////////
@@ -1559,6 +4555,18 @@ namespace rapidxml
             text = tmp;
         }
 
+        // Skip characters until predicate evaluates to true, returning hash of skipped characters
+        template<class StopPred, int Flags>
+        static std::uint32_t skip_and_hash(Ch *&text)
+        {
+            Ch *tmp = text;
+            std::uint32_t hash = internal::hash_basis;
+            while (StopPred::test(*tmp))
+                hash = internal::hash_step(hash, *tmp++);
+            text = tmp;
+            return internal::hash_final(hash);
+        }
+
         // Skip characters until predicate evaluates to true while doing the following:
         // - replacing XML character entity references with proper characters (&apos; &amp; &quot; &lt; &gt; &#...;)
         // - condensing whitespace sequences to single space character
@@ -1715,6 +4723,21 @@ namespace rapidxml
 
         ///////////////////////////////////////////////////////////////////////
         // Internal parsing functions
+
+        // Link node created by the parser after the previously created one, which precedes it in document order
+        template<int Flags>
+        void link_in_order(xml_node<Ch> *node)
+        {
+#ifdef RAPIDXML_DOCUMENT_ORDER
+            if (Flags & parse_document_order)
+            {
+                m_order_tail->m_next_in_order = node;
+                m_order_tail = node;
+            }
+#else
+            (void)node;
+#endif
+        }
         
         // Parse BOM, if any
         template<int Flags>
@@ -1749,6 +4772,7 @@ namespace rapidxml
 
             // Create declaration
             xml_node<Ch> *declaration = this->allocate_node(node_type::node_declaration);
+            link_in_order<Flags>(declaration);
 
             // Skip whitespace before attributes or ?>
             skip<whitespace_pred, Flags>(text);
@@ -1795,6 +4819,7 @@ namespace rapidxml
 
             // Create comment node
             xml_node<Ch> *comment = this->allocate_node(node_type::node_comment);
+            link_in_order<Flags>(comment);
             comment->value(value, static_cast<std::size_t>(text - value));
             
             // Place zero terminator after comment value
@@ -1854,6 +4879,7 @@ namespace rapidxml
             {
                 // Create a new doctype node
                 xml_node<Ch> *doctype = this->allocate_node(node_type::node_doctype);
+                link_in_order<Flags>(doctype);
                 doctype->value(value, static_cast<std::size_t>(text - value));
                 
                 // Place zero terminator after value
@@ -1880,6 +4906,7 @@ namespace rapidxml
             {
                 // Create pi node
                 xml_node<Ch> *pi = this->allocate_node(node_type::node_pi);
+                link_in_order<Flags>(pi);
 
                 // Extract PI target name
                 Ch *name = text;
@@ -1968,6 +4995,7 @@ namespace rapidxml
             if (!(Flags & parse_no_data_nodes))
             {
                 xml_node<Ch> *data = this->allocate_node(node_type::node_data);
+                link_in_order<Flags>(data);
                 data->value(value, static_cast<std::size_t>(end - value));
                 node->append_node(data);
             }
@@ -2018,6 +5046,7 @@ namespace rapidxml
 
             // Create new cdata node
             xml_node<Ch> *cdata = this->allocate_node(node_type::node_cdata);
+            link_in_order<Flags>(cdata);
             cdata->value(value, static_cast<std::size_t>(text - value));
 
             // Place zero terminator after value
@@ -2034,13 +5063,23 @@ namespace rapidxml
         {
             // Create element node
             xml_node<Ch> *element = this->allocate_node(node_type::node_element);
+            link_in_order<Flags>(element);
 
             // Extract element name
             Ch *name = text;
-            skip<node_name_pred, Flags>(text);
+            std::uint32_t hash = 0;
+            if (Flags & internal::parse_hashing)
+                hash = skip_and_hash<node_name_pred, Flags>(text);
+            else
+                skip<node_name_pred, Flags>(text);
             if (text == name)
                 RAPIDXML_PARSE_ERROR("expected element name", text);
             element->name(name, static_cast<std::size_t>(text - name));
+            element->name_hash(hash);
+            if (Flags & parse_intern_names)
+                element->symbol(m_symbols->intern(name, element->m_name_size, hash));
+            else if (Flags & internal::parse_vocabulary)
+                element->symbol(m_classify(m_vocabulary, name, element->m_name_size, hash));
             
             // Skip whitespace between element name and attributes or >
             skip<whitespace_pred, Flags>(text);
@@ -2163,6 +5202,7 @@ namespace rapidxml
         void parse_node_contents(Ch *&text, xml_node<Ch> *node)
         {
             // For all children and text
+            std::size_t children = 0;
             while (1)
             {
                 // Skip whitespace between > and node contents
@@ -2208,6 +5248,11 @@ namespace rapidxml
                         if (*text != Ch('>'))
                             RAPIDXML_PARSE_ERROR("expected >", text);
                         ++text;     // Skip '>'
+
+                        // Index children of wide element if requested
+                        if (Flags & parse_index_wide_elements)
+                            if (children >= RAPIDXML_CHILD_INDEX_THRESHOLD)
+                                this->index_children(node);
                         return;     // Node closed, finished parsing contents
                     }
                     else
@@ -2215,7 +5260,10 @@ namespace rapidxml
                         // Child node
                         ++text;     // Skip '<'
                         if (xml_node<Ch> *child = parse_node<Flags>(text))
+                        {
                             node->append_node(child);
+                            ++children;
+                        }
 
                         // Skip whitespace between closing-tag of child node
                         // and the next element (clown, 2009/10/14, https://sourceforge.net/p/rapidxml/patches/4/).
@@ -2242,19 +5290,32 @@ namespace rapidxml
         void parse_node_attributes(Ch *&text, xml_node<Ch> *node)
         {
             // For all attributes 
+            std::size_t count = 0;
             while (attribute_name_pred::test(*text))
             {
                 // Extract attribute name
                 Ch *name = text;
-                ++text;     // Skip first character of attribute name
-                skip<attribute_name_pred, Flags>(text);
+                std::uint32_t hash = 0;
+                if (Flags & internal::parse_hashing)
+                    hash = skip_and_hash<attribute_name_pred, Flags>(text);    // First character is already known to match
+                else
+                {
+                    ++text;     // Skip first character of attribute name
+                    skip<attribute_name_pred, Flags>(text);
+                }
                 if (text == name)
                     RAPIDXML_PARSE_ERROR("expected attribute name", name);
 
                 // Create new attribute
                 xml_attribute<Ch> *attribute = this->allocate_attribute();
                 attribute->name(name, static_cast<std::size_t>(text - name));
+                attribute->name_hash(hash);
+                if (Flags & parse_intern_names)
+                    attribute->symbol(m_symbols->intern(name, attribute->m_name_size, hash));
+                else if (Flags & internal::parse_vocabulary)
+                    attribute->symbol(m_classify(m_vocabulary, name, attribute->m_name_size, hash));
                 node->append_attribute(attribute);
+                ++count;
 
                 // Skip whitespace after attribute name
                 skip<whitespace_pred, Flags>(text);
@@ -2300,8 +5361,43 @@ namespace rapidxml
                 // Skip whitespace after attribute value
                 skip<whitespace_pred, Flags>(text);
             }
+
+            // Store attributes as array if requested
+            if (Flags & parse_contiguous_attributes)
+                if (count > 0)
+                    this->make_attribute_array(node, count);
+
+            // Index values if requested, once attributes are in their final place
+            if (Flags & parse_id_index)
+                for (xml_attribute<Ch> *attribute = node->first_attribute(); attribute; attribute = attribute->next_attribute())
+                    m_id_index->insert(attribute);
+        }
+
+        // Classify name with vocabulary of type xml_vocabulary<Ch, N>
+        template<std::size_t N>
+        static std::uint32_t classify(const void *vocabulary, const Ch *name, std::size_t size, std::uint32_t hash)
+        {
+            return static_cast<const xml_vocabulary<Ch, N> *>(vocabulary)->find(name, size, hash);
         }
 
+        xml_symbol_table<Ch> *m_symbols;    // Symbol table used by rapidxml::parse_intern_names, or 0 if none
+        const void *m_vocabulary;           // Vocabulary used by parse() overload taking a vocabulary while it runs, or 0
+        std::uint32_t (*m_classify)(const void *, const Ch *, std::size_t, std::uint32_t);     // Function looking up a name in m_vocabulary
+        xml_id_index<Ch> *m_id_index;       // ID index kept consistent with attributes, or 0 if none
+        std::size_t m_generation;           // Number of modifications of the document
+        xml_node<Ch> *m_order_tail;         // Last node linked in document order while parsing
+        std::size_t m_order_generation;     // Generation in which nodes were linked in document order
+        bool m_order_linked;                // Whether nodes were linked in document order
+        bool m_updates_deferred;            // Whether updates of generation and ID index are deferred, see defer_updates()
+
+    protected:
+
+        //! \cond internal
+        char *m_embedded_memory;            // Static memory embedded in derived document, or 0 if none
+        std::size_t m_embedded_size;        // Size of embedded static memory
+        bool m_embedded_released;           // Whether embedded static memory was detached from the pool, so that the pool can be taken over
+        //! \endcond
+
     };
 
     //! \cond internal
@@ -0,0 +1,326 @@
+#ifndef RAPIDXML_CONCURRENT_HPP_INCLUDED
+#define RAPIDXML_CONCURRENT_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_concurrent.hpp This file contains concurrent_memory_pool, a memory pool
+//! from which nodes, attributes and strings can be allocated by several threads at once
+
+#include "rapidxml.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#ifndef RAPIDXML_CONCURRENT_REGION_SIZE
+    // Size of region of a block of concurrent_memory_pool reserved by a thread for its own allocations.
+    // Define RAPIDXML_CONCURRENT_REGION_SIZE before including rapidxml_concurrent.hpp if you want to override the default value.
+    // Larger regions make threads reserve memory less often, at the cost of more memory left unused at the end of each region.
+    #define RAPIDXML_CONCURRENT_REGION_SIZE (4 * 1024)
+#endif
+
+namespace rapidxml
+{
+
+    //! \cond internal
+    namespace internal
+    {
+
+        // Get a stamp never returned before, identifying a concurrent_memory_pool between calls to its clear()
+        inline std::uint64_t next_pool_stamp()
+        {
+            static std::atomic<std::uint64_t> stamp(0);
+            return stamp.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+    }
+    //! \endcond
+
+    //! Memory pool from which nodes, attributes and strings can be allocated by several threads at once,
+    //! so that several threads can build parts of one tree at the same time.
+    //! Allocation functions have the same meaning as those of memory_pool, and are safe to call concurrently.
+    //! Nodes and attributes it allocates are ordinary xml_node and xml_attribute objects,
+    //! so they can be linked into any tree, including one of an xml_document; the pool must then outlive the document.
+    //! Linking nodes into a tree is not synchronized, so each thread should only modify its own part of the tree.
+    //! <br><br>
+    //! Memory is obtained in blocks of <code>RAPIDXML_DYNAMIC_POOL_SIZE</code> bytes, shared by all threads.
+    //! Each thread reserves a region of <code>RAPIDXML_CONCURRENT_REGION_SIZE</code> bytes of the current block at a time with a single atomic addition,
+    //! and allocates from its region without any synchronization, just like memory_pool allocates from its block;
+    //! allocations larger than a quarter of a region are reserved directly from the block.
+    //! A thread keeps regions of a few pools at once, and memory left in a region it no longer uses is wasted until the pool is cleared.
+    //! Only allocation of a new block takes a lock, so the memory resource does not have to be thread-safe.
+    //! <br><br>
+    //! There are no free lists; all memory is freed at once by clear() or destructor,
+    //! which must not run concurrently with any allocation.
+    //! \param Ch Character type of created nodes.
+    template<class Ch = char>
+    class concurrent_memory_pool
+    {
+
+    public:
+
+        //! Constructs empty pool which obtains its blocks from a memory resource.
+        //! The resource must outlive the pool, or at least the last call to clear().
+        //! \param resource Memory resource to allocate blocks from, or 0 to use global <code>new[]</code> and <code>delete[]</code>.
+        explicit concurrent_memory_pool(std::pmr::memory_resource *resource = 0)
+            : m_current(0)
+            , m_stamp(internal::next_pool_stamp())
+            , m_resource(resource)
+        {
+        }
+
+        //! Destroys pool and frees all the memory.
+        //! Nodes allocated from the pool are no longer valid.
+        ~concurrent_memory_pool()
+        {
+            clear();
+        }
+
+        //! Allocates a new node from the pool, and optionally assigns name and value to it; see memory_pool::allocate_node().
+        //! This function can be called by several threads at once.
+        //! \param type Type of node to create.
+        //! \param name Name to assign to the node, or 0 to assign no name.
+        //! \param value Value to assign to the node, or 0 to assign no value.
+        //! \param name_size Size of name to assign, or 0 to automatically calculate size from name string.
+        //! \param value_size Size of value to assign, or 0 to automatically calculate size from value string.
+        //! \return Pointer to allocated node. This pointer will never be NULL.
+        xml_node<Ch> *allocate_node(node_type type,
+                                    const Ch *name = 0, const Ch *value = 0,
+                                    std::size_t name_size = 0, std::size_t value_size = 0)
+        {
+            xml_node<Ch> *node = new(allocate_aligned(sizeof(xml_node<Ch>))) xml_node<Ch>(type);
+            if (name)
+            {
+                if (name_size > 0)
+                    node->name(name, name_size);
+                else
+                    node->name(name);
+            }
+            if (value)
+            {
+                if (value_size > 0)
+                    node->value(value, value_size);
+                else
+                    node->value(value);
+            }
+            return node;
+        }
+
+        //! Allocates a new attribute from the pool, and optionally assigns name and value to it; see memory_pool::allocate_attribute().
+        //! This function can be called by several threads at once.
+        //! \param name Name to assign to the attribute, or 0 to assign no name.
+        //! \param value Value to assign to the attribute, or 0 to assign no value.
+        //! \param name_size Size of name to assign, or 0 to automatically calculate size from name string.
+        //! \param value_size Size of value to assign, or 0 to automatically calculate size from value string.
+        //! \return Pointer to allocated attribute. This pointer will never be NULL.
+        xml_attribute<Ch> *allocate_attribute(const Ch *name = 0, const Ch *value = 0,
+                                              std::size_t name_size = 0, std::size_t value_size = 0)
+        {
+            xml_attribute<Ch> *attribute = new(allocate_aligned(sizeof(xml_attribute<Ch>))) xml_attribute<Ch>;
+            if (name)
+            {
+                if (name_size > 0)
+                    attribute->name(name, name_size);
+                else
+                    attribute->name(name);
+            }
+            if (value)
+            {
+                if (value_size > 0)
+                    attribute->value(value, value_size);
+                else
+                    attribute->value(value);
+            }
+            return attribute;
+        }
+
+        //! Allocates a char array of given size from the pool, and optionally copies a given string to it; see memory_pool::allocate_string().
+        //! This function can be called by several threads at once.
+        //! \param source String to initialize the allocated memory with, or 0 to not initialize it.
+        //! \param size Number of characters to allocate, or zero to calculate it automatically from source string length; if size is 0, source string must be specified and null terminated.
+        //! \return Pointer to allocated char array. This pointer will never be NULL.
+        Ch *allocate_string(const Ch *source = 0, std::size_t size = 0)
+        {
+            assert(source || size);     // Either source or size (or both) must be specified
+            if (size == 0)
+                size = internal::measure(source) + 1;
+            Ch *result = static_cast<Ch *>(allocate_aligned(size * sizeof(Ch)));
+            if (source)
+                for (std::size_t i = 0; i < size; ++i)
+                    result[i] = source[i];
+            return result;
+        }
+
+        //! Clears the pool, freeing all its memory.
+        //! Any nodes or strings allocated from the pool will no longer be valid.
+        //! This must not be called while any thread allocates from the pool.
+        void clear()
+        {
+            block *current = m_current.load(std::memory_order_acquire);
+            while (current)
+            {
+                block *previous = current->previous;
+                std::size_t size = current->size;
+                current->~block();
+                free_raw(reinterpret_cast<char *>(current), size);
+                current = previous;
+            }
+            m_current.store(0, std::memory_order_release);
+
+            // Regions reserved by threads so far belong to freed blocks
+            m_stamp = internal::next_pool_stamp();
+        }
+
+        //! Gets memory resource used to allocate blocks of the pool.
+        //! \return Pointer to memory resource, or 0 if global <code>new[]</code> and <code>delete[]</code> are used.
+        std::pmr::memory_resource *memory_resource() const
+        {
+            return m_resource;
+        }
+
+    private:
+
+        struct block
+        {
+            block *previous;                        // Previously allocated block, or 0 if none
+            std::size_t size;                       // Size of raw memory of the block, including this header
+            std::size_t capacity;                   // Number of bytes available for allocations
+            std::atomic<std::size_t> used;          // Number of bytes reserved so far; may exceed capacity after failed reservations
+        };
+
+        // Region of a block reserved by a thread
+        struct region
+        {
+            std::uint64_t stamp;                    // Stamp of the pool the region belongs to, or 0 if none
+            char *ptr;                              // First free byte of the region
+            char *end;                              // One past last byte of the region
+        };
+
+        // Number of regions of different pools kept by each thread
+        static const std::size_t region_slots = 4;
+
+        static std::size_t aligned_size(std::size_t size)
+        {
+            return (size + RAPIDXML_ALIGNMENT - 1) & ~std::size_t(RAPIDXML_ALIGNMENT - 1);
+        }
+
+        static char *data(block *b)
+        {
+            char *start = reinterpret_cast<char *>(b) + sizeof(block);
+            return start + ((RAPIDXML_ALIGNMENT - (std::size_t(start) & (RAPIDXML_ALIGNMENT - 1))) & (RAPIDXML_ALIGNMENT - 1));
+        }
+
+        // Get region of the calling thread for this pool, which may belong to another pool or an earlier generation of this one.
+        // If no slot holds a region of this pool, an unused slot is taken, or else slots are evicted in turn,
+        // so that a thread alternating between up to region_slots pools keeps a region of each.
+        region &local_region() const
+        {
+            static thread_local region regions[region_slots] = {};
+            static thread_local std::size_t victim = 0;
+            for (std::size_t i = 0; i < region_slots; ++i)
+                if (regions[i].stamp == m_stamp)
+                    return regions[i];
+            for (std::size_t i = 0; i < region_slots; ++i)
+                if (!regions[i].stamp)
+                    return regions[i];
+            victim = (victim + 1) % region_slots;
+            return regions[victim];
+        }
+
+        void *allocate_aligned(std::size_t size)
+        {
+            size = aligned_size(size);
+            if (size > RAPIDXML_CONCURRENT_REGION_SIZE / 4)
+                return reserve(size);
+            region &local = local_region();
+            if (local.stamp != m_stamp || local.ptr + size > local.end)
+            {
+                std::size_t region_size = aligned_size(RAPIDXML_CONCURRENT_REGION_SIZE);
+                local.ptr = reserve(region_size);
+                local.end = local.ptr + region_size;
+                local.stamp = m_stamp;
+            }
+            char *result = local.ptr;
+            local.ptr += size;
+            return result;
+        }
+
+        // Reserve memory from the current block, allocating a new block if it does not fit
+        char *reserve(std::size_t size)
+        {
+            while (true)
+            {
+                block *current = m_current.load(std::memory_order_acquire);
+                if (current)
+                {
+                    std::size_t offset = current->used.fetch_add(size, std::memory_order_relaxed);
+                    if (offset + size <= current->capacity)
+                        return data(current) + offset;
+                }
+                grow(current, size);
+            }
+        }
+
+        // Allocate a new block for at least size bytes, unless another thread has replaced expected block already
+        void grow(block *expected, std::size_t size)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_current.load(std::memory_order_relaxed) != expected)
+                return;
+            std::size_t overhead = sizeof(block) + RAPIDXML_ALIGNMENT - 1;
+            std::size_t alloc_size = RAPIDXML_DYNAMIC_POOL_SIZE;
+            if (alloc_size < size + overhead)
+                alloc_size = size + overhead;
+            block *b = new(allocate_raw(alloc_size)) block;
+            b->previous = expected;
+            b->size = alloc_size;
+            b->capacity = alloc_size - static_cast<std::size_t>(data(b) - reinterpret_cast<char *>(b));
+            b->used.store(0, std::memory_order_relaxed);
+            m_current.store(b, std::memory_order_release);
+        }
+
+        char *allocate_raw(std::size_t size)
+        {
+            void *memory;
+            if (m_resource)
+            {
+                memory = m_resource->allocate(size, alignof(block));
+                assert(memory); // Allocator is not allowed to return 0, on failure it must either throw, stop the program or use longjmp
+            }
+            else
+            {
+                memory = new char[size];
+#ifdef RAPIDXML_NO_EXCEPTIONS
+                if (!memory)            // If exceptions are disabled, verify memory allocation, because new will not be able to throw bad_alloc
+                {
+                    parse_error_handler("out of memory", 0);
+                    assert(0);
+                }
+#endif
+            }
+            return static_cast<char *>(memory);
+        }
+
+        void free_raw(char *memory, std::size_t size)
+        {
+            if (m_resource)
+                m_resource->deallocate(memory, size, alignof(block));
+            else
+                delete[] memory;
+        }
+
+        // No copying
+        concurrent_memory_pool(const concurrent_memory_pool &);
+        void operator =(const concurrent_memory_pool &);
+
+        std::atomic<block *> m_current;                 // Block allocations are reserved from, or 0 if none
+        std::uint64_t m_stamp;                          // Stamp identifying regions of this pool, changed by clear()
+        std::pmr::memory_resource *m_resource;          // Memory resource for blocks, or 0 if default is to be used
+        std::mutex m_mutex;                             // Lock taken while allocating a new block
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,557 @@
+#ifndef RAPIDXML_INDEX_HPP_INCLUDED
+#define RAPIDXML_INDEX_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_index.hpp This file contains xml_ordered_index, a sorted secondary index
+//! on attribute or child element values of nodes, answering range queries
+
+#include "rapidxml.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rapidxml
+{
+
+    //! Type of keys of xml_ordered_index, which determines how values are parsed and ordered.
+    enum class key_type
+    {
+        key_integer,    //!< Signed 64-bit integers, in decimal notation.
+        key_float,      //!< Double precision floating point numbers, in decimal or scientific notation. Nodes with NaN keys are not indexed.
+        key_string      //!< Strings, ordered by character codes, so that UTF-8 strings are ordered by code points.
+    };
+
+    //! Source of keys of xml_ordered_index.
+    enum class key_source
+    {
+        key_attribute,  //!< Value of first attribute of the node with key name.
+        key_child       //!< Value of first child element of the node with key name.
+    };
+
+    //! Sorted index of nodes of a tree, keyed by value of an attribute or child element, answering range queries in logarithmic time.
+    //! Index is a snapshot: it is not updated when the tree is modified, and must be rebuilt with build() afterwards.
+    //! Nodes whose key is missing or cannot be parsed as key type are not indexed.
+    //! Nodes with equal keys are kept in document order.
+    //! <br><br>
+    //! Index can be saved with save() as a sequence of positions of indexed nodes in the tree,
+    //! and restored with load() against the same tree, for example after parsing the same text again, without sorting.
+    //! \param Ch Character type to use.
+    template<class Ch = char>
+    class xml_ordered_index
+    {
+
+        struct entry;
+
+    public:
+
+        //! Iterator over nodes matching a query, in order of keys.
+        class iterator
+        {
+
+        public:
+
+            typedef xml_node<Ch> *value_type;
+            typedef xml_node<Ch> *reference;
+            typedef xml_node<Ch> **pointer;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::forward_iterator_tag iterator_category;
+
+            iterator()
+                : m_entry(0)
+            {
+            }
+
+            xml_node<Ch> *operator *() const
+            {
+                return m_entry->node;
+            }
+
+            iterator &operator++()
+            {
+                ++m_entry;
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator tmp = *this;
+                ++m_entry;
+                return tmp;
+            }
+
+            bool operator ==(const iterator &rhs) const
+            {
+                return m_entry == rhs.m_entry;
+            }
+
+            bool operator !=(const iterator &rhs) const
+            {
+                return m_entry != rhs.m_entry;
+            }
+
+        private:
+
+            friend class xml_ordered_index;
+
+            explicit iterator(const entry *e)
+                : m_entry(e)
+            {
+            }
+
+            const entry *m_entry;
+
+        };
+
+        //! Nodes matching a query, usable in range-based for loops.
+        class result
+        {
+
+        public:
+
+            //! Gets iterator to first matching node.
+            iterator begin() const
+            {
+                return m_begin;
+            }
+
+            //! Gets iterator past last matching node.
+            iterator end() const
+            {
+                return m_end;
+            }
+
+            //! Gets number of matching nodes.
+            std::size_t size() const
+            {
+                return static_cast<std::size_t>(m_end.m_entry - m_begin.m_entry);
+            }
+
+            //! Checks if no nodes match.
+            bool empty() const
+            {
+                return m_begin == m_end;
+            }
+
+        private:
+
+            friend class xml_ordered_index;
+
+            result(const entry *begin, const entry *end)
+                : m_begin(begin)
+                , m_end(end)
+            {
+            }
+
+            iterator m_begin;
+            iterator m_end;
+
+        };
+
+        //! Constructs empty index.
+        //! \param type Type of keys.
+        //! \param source Whether keys are values of attributes or of child elements.
+        //! \param resource Memory resource to allocate memory of the index from, or 0 to use global <code>new</code> and <code>delete</code>.
+        explicit xml_ordered_index(key_type type, key_source source = key_source::key_attribute, std::pmr::memory_resource *resource = 0)
+            : m_type(type)
+            , m_source(source)
+            , m_element_name(0)
+            , m_element_name_size(0)
+            , m_key_name(0)
+            , m_key_name_size(0)
+            , m_entries(resource ? resource : std::pmr::new_delete_resource())
+        {
+        }
+
+        //! Gets type of keys.
+        //! \return Type of keys.
+        key_type type() const
+        {
+            return m_type;
+        }
+
+        //! Gets number of indexed nodes.
+        //! \return Number of nodes.
+        std::size_t size() const
+        {
+            return m_entries.size();
+        }
+
+        //! Builds the index from elements of a tree, replacing previous contents.
+        //! Parsing and sorting of keys can be split between several threads; the tree is only read while building.
+        //! \param root Root of the tree; its descendant elements are indexed.
+        //! \param element_name Name of elements to index, or 0 to index all elements; the string must be zero-terminated.
+        //! \param key_name Name of attribute or child element holding the key; the string must be zero-terminated.
+        //! \param threads Number of threads to use, or 0 to use one thread per hardware thread.
+        void build(xml_node<Ch> *root, const Ch *element_name, const Ch *key_name, unsigned threads = 1)
+        {
+            assert(root && key_name);
+            set_names(element_name, key_name);
+            m_entries.clear();
+
+            // Collect candidate elements in document order
+            std::uint32_t ordinal = 0;
+            for (xml_node<Ch> *node = next(root, root); node; node = next(root, node), ++ordinal)
+                if (matches(node))
+                {
+                    entry e;
+                    e.node = node;
+                    e.ordinal = ordinal;
+                    m_entries.push_back(e);
+                }
+
+            // Parse keys and sort chunks, then merge them
+            if (threads == 0)
+                threads = (std::max)(1u, std::thread::hardware_concurrency());
+            std::size_t chunk_count = (std::min<std::size_t>)(threads, m_entries.size() / min_chunk + 1);
+            std::vector<std::size_t> bounds(chunk_count + 1);
+            std::vector<std::size_t> ends(chunk_count);
+            for (std::size_t chunk = 0; chunk <= chunk_count; ++chunk)
+                bounds[chunk] = m_entries.size() * chunk / chunk_count;
+            run(chunk_count, [&](std::size_t chunk)
+            {
+                ends[chunk] = prepare(bounds[chunk], bounds[chunk + 1]);
+            });
+            std::size_t size = 0;
+            for (std::size_t chunk = 0; chunk < chunk_count; ++chunk)
+            {
+                std::size_t begin = size;
+                size = std::move(m_entries.begin() + bounds[chunk], m_entries.begin() + ends[chunk], m_entries.begin() + size) - m_entries.begin();
+                bounds[chunk] = begin;
+            }
+            bounds[chunk_count] = size;
+            m_entries.resize(size);
+            merge(bounds);
+        }
+
+        //! Finds nodes whose integer keys are in a closed interval.
+        //! Index must have rapidxml::key_type::key_integer keys.
+        //! \param low Smallest key to find.
+        //! \param high Largest key to find.
+        //! \return Matching nodes, in order of keys.
+        result integer_range(std::int64_t low, std::int64_t high) const
+        {
+            assert(m_type == key_type::key_integer);
+            entry lo, hi;
+            lo.integer = low;
+            hi.integer = high;
+            return range(lo, hi);
+        }
+
+        //! Finds nodes whose floating point keys are in a closed interval.
+        //! Index must have rapidxml::key_type::key_float keys.
+        //! \param low Smallest key to find.
+        //! \param high Largest key to find.
+        //! \return Matching nodes, in order of keys.
+        result float_range(double low, double high) const
+        {
+            assert(m_type == key_type::key_float);
+            entry lo, hi;
+            lo.floating = low;
+            hi.floating = high;
+            return range(lo, hi);
+        }
+
+        //! Finds nodes whose string keys are in a closed interval.
+        //! Index must have rapidxml::key_type::key_string keys.
+        //! \param low Smallest key to find; the string must be zero-terminated.
+        //! \param high Largest key to find; the string must be zero-terminated.
+        //! \return Matching nodes, in order of keys.
+        result string_range(const Ch *low, const Ch *high) const
+        {
+            assert(m_type == key_type::key_string);
+            entry lo, hi;
+            lo.string = low;
+            lo.string_size = internal::measure(low);
+            hi.string = high;
+            hi.string_size = internal::measure(high);
+            return range(lo, hi);
+        }
+
+        //! Finds nodes whose string keys are equal to a value.
+        //! Index must have rapidxml::key_type::key_string keys.
+        //! \param value Key to find; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of key, in characters, or 0 to have size calculated automatically from string.
+        //! \return Matching nodes, in document order.
+        result string_equal(const Ch *value, std::size_t size = 0) const
+        {
+            assert(m_type == key_type::key_string);
+            entry e;
+            e.string = value;
+            e.string_size = size ? size : internal::measure(value);
+            return range(e, e);
+        }
+
+        //! Gets all indexed nodes.
+        //! \return Indexed nodes, in order of keys.
+        result all() const
+        {
+            return result(m_entries.data(), m_entries.data() + m_entries.size());
+        }
+
+        //! Saves the index as positions of indexed nodes, in order of keys.
+        //! Position of a node is its index among all descendants of the root in document order, counting nodes of every type.
+        //! \param out Output iterator receiving std::uint32_t positions.
+        //! \return Output iterator pointing past the last position written.
+        template<class OutIt>
+        OutIt save(OutIt out) const
+        {
+            for (const entry &e: m_entries)
+                *out++ = e.ordinal;
+            return out;
+        }
+
+        //! Restores index saved with save() against a tree with the same structure, without sorting.
+        //! Keys are read again from the tree; if a position does not denote a node with a valid key, the index is left empty.
+        //! \param root Root of the tree.
+        //! \param element_name Name of indexed elements, as passed to build().
+        //! \param key_name Name of attribute or child element holding the key, as passed to build().
+        //! \param first Iterator to first saved position.
+        //! \param last Iterator past last saved position.
+        //! \return True if index was restored.
+        template<class InIt>
+        bool load(xml_node<Ch> *root, const Ch *element_name, const Ch *key_name, InIt first, InIt last)
+        {
+            assert(root && key_name);
+            set_names(element_name, key_name);
+            m_entries.clear();
+
+            // Map positions to nodes
+            std::pmr::vector<xml_node<Ch> *> nodes(m_entries.get_allocator().resource());
+            for (xml_node<Ch> *node = next(root, root); node; node = next(root, node))
+                nodes.push_back(node);
+
+            // Recreate entries
+            for (; first != last; ++first)
+            {
+                std::uint32_t ordinal = static_cast<std::uint32_t>(*first);
+                entry e;
+                if (ordinal >= nodes.size() || !matches(nodes[ordinal]))
+                    break;
+                e.node = nodes[ordinal];
+                e.ordinal = ordinal;
+                if (!parse_key(e) || (!m_entries.empty() && !less(m_entries.back(), e)))
+                    break;
+                m_entries.push_back(e);
+            }
+            if (first != last)
+            {
+                m_entries.clear();
+                return false;
+            }
+            return true;
+        }
+
+        //! Removes all nodes from the index.
+        void clear()
+        {
+            m_entries.clear();
+        }
+
+    private:
+
+        // Smallest number of candidates worth a separate thread
+        static const std::size_t min_chunk = 4096;
+
+        struct entry
+        {
+            union
+            {
+                std::int64_t integer;
+                double floating;
+                const Ch *string;
+            };
+            std::size_t string_size;    // Size of string key
+            xml_node<Ch> *node;         // Indexed node
+            std::uint32_t ordinal;      // Position of node in document order
+        };
+
+        // No copying
+        xml_ordered_index(const xml_ordered_index &);
+        void operator =(const xml_ordered_index &);
+
+        void set_names(const Ch *element_name, const Ch *key_name)
+        {
+            m_element_name = element_name;
+            m_element_name_size = element_name ? internal::measure(element_name) : 0;
+            m_key_name = key_name;
+            m_key_name_size = internal::measure(key_name);
+        }
+
+        bool matches(xml_node<Ch> *node) const
+        {
+            return node->type() == node_type::node_element &&
+                   (!m_element_name || internal::compare(node->name(), node->name_size(), m_element_name, m_element_name_size, true));
+        }
+
+        // Next node in document order, within tree of root
+        static xml_node<Ch> *next(xml_node<Ch> *root, xml_node<Ch> *node)
+        {
+            if (node->first_node())
+                return node->first_node();
+            while (node != root && !node->next_sibling())
+                node = node->parent();
+            return node == root ? 0 : node->next_sibling();
+        }
+
+        // Run function for each chunk, on separate threads if there are several chunks
+        template<class Fn>
+        static void run(std::size_t chunk_count, Fn fn)
+        {
+            if (chunk_count == 1)
+            {
+                fn(0);
+                return;
+            }
+            std::vector<std::thread> workers;
+            for (std::size_t chunk = 1; chunk < chunk_count; ++chunk)
+                workers.emplace_back(fn, chunk);
+            fn(0);
+            for (std::thread &worker: workers)
+                worker.join();
+        }
+
+        // Parse keys of entries in range, move entries with valid keys to its beginning, and sort them; return end of valid entries
+        std::size_t prepare(std::size_t begin, std::size_t end)
+        {
+            entry *first = m_entries.data() + begin;
+            entry *last = std::remove_if(first, m_entries.data() + end, [this](entry &e) { return !parse_key(e); });
+            std::sort(first, last, [this](const entry &a, const entry &b) { return less(a, b); });
+            return static_cast<std::size_t>(last - m_entries.data());
+        }
+
+        // Merge sorted chunks pairwise, merging pairs of each round on separate threads
+        void merge(std::vector<std::size_t> &bounds)
+        {
+            while (bounds.size() > 2)
+            {
+                std::size_t pairs = (bounds.size() - 1) / 2;
+                run(pairs, [&](std::size_t pair)
+                {
+                    std::inplace_merge(m_entries.begin() + bounds[2 * pair], m_entries.begin() + bounds[2 * pair + 1], m_entries.begin() + bounds[2 * pair + 2],
+                                       [this](const entry &a, const entry &b) { return less(a, b); });
+                });
+                std::vector<std::size_t> merged;
+                for (std::size_t i = 0; i < bounds.size(); i += 2)
+                    merged.push_back(bounds[i]);
+                if (merged.back() != bounds.back())
+                    merged.push_back(bounds.back());
+                bounds.swap(merged);
+            }
+        }
+
+        // Read and parse key of entry's node; return false if key is missing or invalid
+        bool parse_key(entry &e) const
+        {
+            const Ch *value;
+            std::size_t size;
+            if (m_source == key_source::key_attribute)
+            {
+                xml_attribute<Ch> *attribute = e.node->first_attribute(m_key_name, m_key_name_size);
+                if (!attribute)
+                    return false;
+                value = attribute->value();
+                size = attribute->value_size();
+            }
+            else
+            {
+                xml_node<Ch> *child = e.node->first_node(m_key_name, m_key_name_size);
+                if (!child)
+                    return false;
+                value = child->value();
+                size = child->value_size();
+            }
+
+            if (m_type == key_type::key_string)
+            {
+                e.string = value;
+                e.string_size = size;
+                return true;
+            }
+
+            // Copy number into narrow buffer, without surrounding whitespace and leading +
+            char buffer[64];
+            while (size > 0 && internal::lookup_tables<0>::lookup_whitespace[static_cast<unsigned char>(value[0])])
+                ++value, --size;
+            while (size > 0 && internal::lookup_tables<0>::lookup_whitespace[static_cast<unsigned char>(value[size - 1])])
+                --size;
+            if (size > 0 && value[0] == Ch('+'))
+                ++value, --size;
+            if (size == 0 || size > sizeof(buffer))
+                return false;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                if (value[i] < Ch(0x20) || value[i] > Ch(0x7E))
+                    return false;
+                buffer[i] = static_cast<char>(value[i]);
+            }
+
+            std::from_chars_result parsed;
+            if (m_type == key_type::key_integer)
+                parsed = std::from_chars(buffer, buffer + size, e.integer);
+            else
+            {
+                parsed = std::from_chars(buffer, buffer + size, e.floating);
+                if (std::isnan(e.floating))
+                    return false;
+            }
+            return parsed.ec == std::errc() && parsed.ptr == buffer + size;
+        }
+
+        // Compare keys only
+        bool key_less(const entry &a, const entry &b) const
+        {
+            switch (m_type)
+            {
+            case key_type::key_integer:
+                return a.integer < b.integer;
+            case key_type::key_float:
+                return a.floating < b.floating;
+            default:
+            {
+                std::size_t size = (std::min)(a.string_size, b.string_size);
+                int result = std::char_traits<Ch>::compare(a.string, b.string, size);
+                return result < 0 || (result == 0 && a.string_size < b.string_size);
+            }
+            }
+        }
+
+        // Compare keys, then document order
+        bool less(const entry &a, const entry &b) const
+        {
+            if (key_less(a, b))
+                return true;
+            if (key_less(b, a))
+                return false;
+            return a.ordinal < b.ordinal;
+        }
+
+        result range(const entry &low, const entry &high) const
+        {
+            const entry *begin = m_entries.data();
+            const entry *end = begin + m_entries.size();
+            if (key_less(high, low))
+                return result(end, end);
+            const entry *first = std::lower_bound(begin, end, low, [this](const entry &a, const entry &b) { return key_less(a, b); });
+            const entry *last = std::upper_bound(first, end, high, [this](const entry &a, const entry &b) { return key_less(a, b); });
+            return result(first, last);
+        }
+
+        key_type m_type;                            // Type of keys
+        key_source m_source;                        // Source of keys
+        const Ch *m_element_name;                   // Name of indexed elements, or 0 if all elements are indexed
+        std::size_t m_element_name_size;            // Size of name of indexed elements
+        const Ch *m_key_name;                       // Name of attribute or child element holding the key
+        std::size_t m_key_name_size;                // Size of name of key
+        std::pmr::vector<entry> m_entries;          // Entries sorted by key, then document order
+
+    };
+
+}
+
+#endif
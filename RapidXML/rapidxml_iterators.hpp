@@ -8,6 +8,20 @@
 //! \file rapidxml_iterators.hpp This file contains rapidxml iterators
 
 #include "rapidxml.hpp"
+#include <cstddef>      // For std::ptrdiff_t
+#include <iterator>     // For iterator tags
+
+///////////////////////////////////////////////////////////////////////////
+// RAPIDXML_PREFETCH
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define RAPIDXML_PREFETCH(address) __builtin_prefetch(address)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    #include <xmmintrin.h>
+    #define RAPIDXML_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char *>(address), _MM_HINT_T0)
+#else
+    #define RAPIDXML_PREFETCH(address) ((void)(address))
+#endif
 
 namespace rapidxml
 {
@@ -19,9 +33,9 @@ namespace rapidxml
     
     public:
 
-        typedef typename xml_node<Ch> value_type;
-        typedef typename xml_node<Ch> &reference;
-        typedef typename xml_node<Ch> *pointer;
+        typedef xml_node<Ch> value_type;
+        typedef xml_node<Ch> &reference;
+        typedef xml_node<Ch> *pointer;
         typedef std::ptrdiff_t difference_type;
         typedef std::bidirectional_iterator_tag iterator_category;
         
@@ -57,7 +71,7 @@ namespace rapidxml
         node_iterator operator++(int)
         {
             node_iterator tmp = *this;
-            ++this;
+            ++*this;
             return tmp;
         }
 
@@ -71,7 +85,7 @@ namespace rapidxml
         node_iterator operator--(int)
         {
             node_iterator tmp = *this;
-            ++this;
+            --*this;
             return tmp;
         }
 
@@ -98,9 +112,9 @@ namespace rapidxml
     
     public:
 
-        typedef typename xml_attribute<Ch> value_type;
-        typedef typename xml_attribute<Ch> &reference;
-        typedef typename xml_attribute<Ch> *pointer;
+        typedef xml_attribute<Ch> value_type;
+        typedef xml_attribute<Ch> &reference;
+        typedef xml_attribute<Ch> *pointer;
         typedef std::ptrdiff_t difference_type;
         typedef std::bidirectional_iterator_tag iterator_category;
         
@@ -136,7 +150,7 @@ namespace rapidxml
         attribute_iterator operator++(int)
         {
             attribute_iterator tmp = *this;
-            ++this;
+            ++*this;
             return tmp;
         }
 
@@ -150,16 +164,16 @@ namespace rapidxml
         attribute_iterator operator--(int)
         {
             attribute_iterator tmp = *this;
-            ++this;
+            --*this;
             return tmp;
         }
 
-        bool operator ==(const attribute_iterator<Ch> &rhs)
+        bool operator ==(const attribute_iterator<Ch> &rhs) const
         {
             return m_attribute == rhs.m_attribute;
         }
 
-        bool operator !=(const attribute_iterator<Ch> &rhs)
+        bool operator !=(const attribute_iterator<Ch> &rhs) const
         {
             return m_attribute != rhs.m_attribute;
         }
@@ -170,6 +184,199 @@ namespace rapidxml
 
     };
 
+    //! Iterator of descendant nodes of xml_node, in document order (preorder), optionally matching node type and name.
+    //! Iteration does not include the node itself, and allocates no memory: it advances through node links,
+    //! using next node in document order when document has its nodes linked (see rapidxml::parse_document_order and <code>RAPIDXML_DOCUMENT_ORDER</code>),
+    //! and child, sibling and parent links otherwise.
+    //! Next node is prefetched into cache while current node is processed.
+    //! Default constructed iterator is the end iterator.
+    //! <br><br>
+    //! Tree must not be modified during iteration, except that current node may be modified if skip_children() is called first.
+    template<class Ch>
+    class descendant_iterator
+    {
+
+    public:
+
+        typedef xml_node<Ch> value_type;
+        typedef xml_node<Ch> &reference;
+        typedef xml_node<Ch> *pointer;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::forward_iterator_tag iterator_category;
+
+        descendant_iterator()
+            : m_root(0)
+            , m_node(0)
+            , m_end(0)
+            , m_name(0)
+            , m_name_size(0)
+            , m_name_hash(0)
+            , m_type(node_type::node_element)
+            , m_match_type(false)
+            , m_linked(false)
+            , m_skip(false)
+        {
+        }
+
+        //! Constructs iterator positioned at first descendant of node, optionally matching name.
+        //! \param root Node whose descendants are iterated.
+        //! \param name Name of nodes to iterate, or 0 to iterate nodes regardless of their name; this string doesn't have to be zero-terminated if name_size is non-zero.
+        //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+        descendant_iterator(xml_node<Ch> *root, const Ch *name = 0, std::size_t name_size = 0)
+            : m_type(node_type::node_element)
+            , m_match_type(false)
+        {
+            init(root, name, name_size);
+        }
+
+        //! Constructs iterator positioned at first descendant of node of given type, optionally matching name.
+        //! \param root Node whose descendants are iterated.
+        //! \param type Type of nodes to iterate.
+        //! \param name Name of nodes to iterate, or 0 to iterate nodes regardless of their name; this string doesn't have to be zero-terminated if name_size is non-zero.
+        //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+        descendant_iterator(xml_node<Ch> *root, node_type type, const Ch *name = 0, std::size_t name_size = 0)
+            : m_type(type)
+            , m_match_type(true)
+        {
+            init(root, name, name_size);
+        }
+
+        reference operator *() const
+        {
+            assert(m_node);
+            return *m_node;
+        }
+
+        pointer operator->() const
+        {
+            assert(m_node);
+            return m_node;
+        }
+
+        descendant_iterator& operator++()
+        {
+            assert(m_node);
+            do
+                advance();
+            while (m_node && !matches(m_node));
+            return *this;
+        }
+
+        descendant_iterator operator++(int)
+        {
+            descendant_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        //! Makes next increment skip descendants of current node, continuing with its next sibling or next sibling of nearest ancestor.
+        void skip_children()
+        {
+            assert(m_node);
+            m_skip = true;
+        }
+
+        bool operator ==(const descendant_iterator<Ch> &rhs) const
+        {
+            return m_node == rhs.m_node;
+        }
+
+        bool operator !=(const descendant_iterator<Ch> &rhs) const
+        {
+            return m_node != rhs.m_node;
+        }
+
+    private:
+
+        void init(xml_node<Ch> *root, const Ch *name, std::size_t name_size)
+        {
+            assert(root);
+            m_root = root;
+            m_name = name;
+            m_name_size = name && name_size == 0 ? internal::measure(name) : name_size;
+            m_name_hash = name ? internal::hash(name, m_name_size) : 0;
+            m_skip = false;
+
+            // Use links in document order if they are valid, stopping at first node after the tree of root
+            xml_document<Ch, 0> *document = root->document();
+            m_linked = document && document->document_order_linked();
+            m_end = 0;
+            if (m_linked)
+            {
+                for (xml_node<Ch> *node = root; node != document && !m_end; node = node->parent())
+                    m_end = node->next_sibling();
+            }
+
+            m_node = root->first_node();
+            if (m_node)
+            {
+                prefetch();
+                if (!matches(m_node))
+                    ++*this;
+            }
+        }
+
+        bool matches(xml_node<Ch> *node) const
+        {
+            if (m_match_type && node->type() != m_type)
+                return false;
+            if (!m_name)
+                return true;
+            if (node->name_hash() && node->name_hash() != m_name_hash)
+                return false;
+            return internal::compare(node->name(), node->name_size(), m_name, m_name_size, true);
+        }
+
+        // Move to next node in document order within the tree, without matching
+        void advance()
+        {
+            if (m_linked && !m_skip)
+            {
+                m_node = m_node->next_in_document_order();
+                if (m_node == m_end)
+                    m_node = 0;
+            }
+            else
+            {
+                if (!m_skip && m_node->first_node())
+                    m_node = m_node->first_node();
+                else
+                {
+                    while (m_node != m_root && !m_node->next_sibling())
+                        m_node = m_node->parent();
+                    m_node = m_node == m_root ? 0 : m_node->next_sibling();
+                }
+                m_skip = false;
+            }
+            if (m_node)
+                prefetch();
+        }
+
+        // Prefetch node likely to follow current node
+        void prefetch() const
+        {
+            xml_node<Ch> *next = m_linked ? m_node->next_in_document_order() : m_node->first_node();
+            if (!next && !m_linked)
+                next = m_node->next_sibling();
+            if (next)
+                RAPIDXML_PREFETCH(next);
+        }
+
+        xml_node<Ch> *m_root;           // Node whose descendants are iterated
+        xml_node<Ch> *m_node;           // Current node, or 0 at the end
+        xml_node<Ch> *m_end;            // First node after the tree of root in document order, if links are used
+        const Ch *m_name;               // Name of iterated nodes, or 0 if any name matches
+        std::size_t m_name_size;        // Size of name
+        std::uint32_t m_name_hash;      // Hash of name
+        node_type m_type;               // Type of iterated nodes, if m_match_type is true
+        bool m_match_type;              // Whether only nodes of m_type are iterated
+        bool m_linked;                  // Whether links in document order are used
+        bool m_skip;                    // Whether next advance skips children of current node
+
+    };
+
 }
 
+#undef RAPIDXML_PREFETCH
+
 #endif
@@ -0,0 +1,266 @@
+#ifndef RAPIDXML_PAGES_HPP_INCLUDED
+#define RAPIDXML_PAGES_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_pages.hpp This file contains page_resource, a memory resource
+//! which backs memory_pool blocks directly with virtual memory pages
+
+#include "rapidxml.hpp"
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #define RAPIDXML_PAGES_WINDOWS
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #define RAPIDXML_PAGES_POSIX
+#endif
+
+#if !defined(RAPIDXML_NO_EXCEPTIONS)
+    #include <new>      // For std::bad_alloc
+#endif
+
+namespace rapidxml
+{
+
+    ///////////////////////////////////////////////////////////////////////
+    // Page backing flags
+
+    //! Page flag instructing page_resource to ask the system for transparent huge pages (<code>MADV_HUGEPAGE</code>).
+    //! Mappings for requests of at least 2 MB are rounded and aligned to 2 MB, so that the kernel can back them with huge pages.
+    //! Ignored on systems that do not support transparent huge pages.
+    //! Can be combined with other flags by use of | operator.
+    const int pages_transparent_huge = 0x1;
+
+    //! Page flag instructing page_resource to map explicit 2 MB pages (<code>MAP_HUGETLB</code> or <code>MEM_LARGE_PAGES</code>) for requests of at least 2 MB.
+    //! If the system cannot provide them, for example because no huge pages are reserved or the process lacks privileges,
+    //! regular pages are used instead, with transparent huge pages requested where supported.
+    //! Can be combined with other flags by use of | operator.
+    const int pages_explicit_huge = 0x2;
+
+    //! Page flag instructing page_resource to fault in all pages when a block is allocated,
+    //! so that first touch while parsing does not cause page faults.
+    //! Can be combined with other flags by use of | operator.
+    const int pages_prefault = 0x4;
+
+    //! Page flag instructing page_resource to lock blocks in physical memory (<code>mlock</code> or <code>VirtualLock</code>).
+    //! Locking is best effort; if it fails, for example because of <code>RLIMIT_MEMLOCK</code>, blocks remain unlocked.
+    //! Implies rapidxml::pages_prefault.
+    //! Can be combined with other flags by use of | operator.
+    const int pages_lock = 0x8;
+
+    //! Memory resource allocating each request as a separate mapping of virtual memory pages.
+    //! Pass it to memory_pool or xml_document constructor, or to memory_pool::set_memory_resource(),
+    //! to have all dynamic blocks of the pool, including blocks made for single allocations larger than <code>RAPIDXML_DYNAMIC_POOL_SIZE</code>,
+    //! allocated according to page flags.
+    //! <br><br>
+    //! Every request is rounded up to whole pages.
+    //! Huge pages are used only for requests of at least one huge page, which are rounded up to whole huge pages;
+    //! smaller requests are mapped with regular pages even if huge pages are requested, so that they do not waste, or prefault, up to 2 MB each.
+    //! Pool blocks have <code>RAPIDXML_DYNAMIC_POOL_SIZE</code> bytes, 64 KB by default, so define it as <code>(2 * 1024 * 1024)</code> or more
+    //! to have them backed by huge pages.
+    //! On systems without virtual memory API, requests are forwarded to <code>std::pmr::new_delete_resource()</code> and page flags are ignored.
+    //! <br><br>
+    //! Resource is stateless apart from its flags, so it can be shared by any number of pools, also from multiple threads.
+    //! Only the same instance compares equal, so pools which adopt each other's memory, see memory_pool::adopt(), have to share one instance.
+    class page_resource: public std::pmr::memory_resource
+    {
+
+    public:
+
+        //! Size of huge page requested by huge page flags.
+        static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+        //! Constructs resource using given page flags.
+        //! \param flags Combination of page flags, or 0 to use regular pages with no prefaulting or locking.
+        explicit page_resource(int flags = 0)
+            : m_flags(flags & pages_lock ? flags | pages_prefault : flags)
+        {
+        }
+
+        //! Gets page flags of the resource.
+        //! \return Page flags.
+        int flags() const
+        {
+            return m_flags;
+        }
+
+        //! Gets granularity of mapping made by the resource for a request.
+        //! \param bytes Size of request, in bytes.
+        //! \return Size, in bytes, to whose multiple the request is rounded up: huge page size if huge pages are used for it, otherwise system page size.
+        std::size_t granularity(std::size_t bytes) const
+        {
+            return huge(bytes) ? huge_page_size : system_page_size();
+        }
+
+    private:
+
+        static std::size_t system_page_size()
+        {
+#if defined(RAPIDXML_PAGES_WINDOWS)
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<std::size_t>(info.dwPageSize);
+#elif defined(RAPIDXML_PAGES_POSIX)
+            return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+            return RAPIDXML_ALIGNMENT;
+#endif
+        }
+
+        // Check if huge pages are requested and used for a request of given size
+        bool huge(std::size_t bytes) const
+        {
+            return (m_flags & (pages_transparent_huge | pages_explicit_huge)) && bytes >= huge_page_size;
+        }
+
+        std::size_t round(std::size_t bytes) const
+        {
+            std::size_t page = granularity(bytes);
+            return (bytes + page - 1) / page * page;
+        }
+
+        static void *out_of_memory()
+        {
+#if defined(RAPIDXML_NO_EXCEPTIONS)
+            parse_error_handler("out of memory", 0);
+            return 0;
+#else
+            throw std::bad_alloc();
+#endif
+        }
+
+        // Touch every page of the mapping, so that it is faulted in now rather than during parsing
+        void prefault(char *memory, std::size_t size) const
+        {
+            std::size_t page = system_page_size();
+            for (std::size_t offset = 0; offset < size; offset += page)
+                static_cast<volatile char *>(memory)[offset] = 0;
+        }
+
+#if defined(RAPIDXML_PAGES_WINDOWS)
+
+        virtual void *do_allocate(std::size_t bytes, std::size_t)
+        {
+            std::size_t size = round(bytes);
+            void *memory = 0;
+            if ((m_flags & pages_explicit_huge) && huge(bytes))
+                memory = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);     // Large pages are always resident
+            if (!memory)
+            {
+                memory = VirtualAlloc(0, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+                if (!memory)
+                    return out_of_memory();
+                if (m_flags & pages_prefault)
+                    prefault(static_cast<char *>(memory), size);
+            }
+            if (m_flags & pages_lock)
+                VirtualLock(memory, size);
+            return memory;
+        }
+
+        virtual void do_deallocate(void *p, std::size_t, std::size_t)
+        {
+            VirtualFree(p, 0, MEM_RELEASE);
+        }
+
+#elif defined(RAPIDXML_PAGES_POSIX)
+
+        // Map anonymous memory aligned to huge page boundary, by overallocating and trimming both ends
+        static char *map_aligned(std::size_t size)
+        {
+            std::size_t span = size + huge_page_size;
+            void *memory = mmap(0, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+                return 0;
+            char *raw = static_cast<char *>(memory);
+            char *aligned = reinterpret_cast<char *>((reinterpret_cast<std::size_t>(raw) + huge_page_size - 1) & ~(huge_page_size - 1));
+            if (aligned != raw)
+                munmap(raw, static_cast<std::size_t>(aligned - raw));
+            if (aligned + size != raw + span)
+                munmap(aligned + size, static_cast<std::size_t>(raw + span - (aligned + size)));
+            return aligned;
+        }
+
+        virtual void *do_allocate(std::size_t bytes, std::size_t)
+        {
+            std::size_t size = round(bytes);
+            void *memory = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+            if ((m_flags & pages_explicit_huge) && huge(bytes))
+            {
+                int populate = 0;
+#if defined(MAP_POPULATE)
+                if (m_flags & pages_prefault)
+                    populate = MAP_POPULATE;
+#endif
+                memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+            }
+#endif
+            if (memory == MAP_FAILED)
+            {
+                // Regular pages, with transparent huge pages requested when any huge pages were asked for
+                char *regular;
+                if (huge(bytes))
+                {
+                    regular = map_aligned(size);
+                    if (!regular)
+                        return out_of_memory();
+#if defined(MADV_HUGEPAGE)
+                    madvise(regular, size, MADV_HUGEPAGE);
+#endif
+                }
+                else
+                {
+                    void *mapped = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (mapped == MAP_FAILED)
+                        return out_of_memory();
+                    regular = static_cast<char *>(mapped);
+                }
+                if (m_flags & pages_prefault)
+                    prefault(regular, size);
+                memory = regular;
+            }
+            if (m_flags & pages_lock)
+                mlock(memory, size);
+            return memory;
+        }
+
+        virtual void do_deallocate(void *p, std::size_t bytes, std::size_t)
+        {
+            munmap(p, round(bytes));    // Also unlocks locked pages
+        }
+
+#else
+
+        virtual void *do_allocate(std::size_t bytes, std::size_t alignment)
+        {
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        virtual void do_deallocate(void *p, std::size_t bytes, std::size_t alignment)
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+#endif
+
+        // Resource cannot tell whether other resource is a page resource too without RTTI, so only the same instance is equal
+        virtual bool do_is_equal(const std::pmr::memory_resource &other) const noexcept
+        {
+            return this == &other;
+        }
+
+        int m_flags;    // Page flags
+
+    };
+
+}
+
+#undef RAPIDXML_PAGES_WINDOWS
+#undef RAPIDXML_PAGES_POSIX
+
+#endif
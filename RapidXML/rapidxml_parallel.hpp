@@ -0,0 +1,365 @@
+#ifndef RAPIDXML_PARALLEL_HPP_INCLUDED
+#define RAPIDXML_PARALLEL_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_parallel.hpp This file contains parallel_for_each_descendant() and parallel_transform(),
+//! which visit nodes of a tree on several threads, splitting it into subtree tasks
+
+#include "rapidxml.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rapidxml
+{
+
+    //! \cond internal
+    namespace internal
+    {
+
+        // Smallest number of children of a node for which they are always split off into separate tasks
+        const std::size_t parallel_split = 64;
+
+        // Number of siblings in each task split off from a node with at least parallel_split children
+        const std::size_t parallel_grain = 32;
+
+        // Runs a visitor on all descendants of a node on several threads.
+        // A task is a range of siblings, visited together with their subtrees in document order.
+        // Each thread takes tasks from the back of its own queue, and steals them from the front of queues of other threads when it runs out.
+        // Children of a node are split off into tasks when there are many of them, judged by their count, or when some thread is idle;
+        // otherwise they are visited by the thread which visited the node.
+        template<class Ch, class Visit>
+        class subtree_scheduler
+        {
+
+        public:
+
+            subtree_scheduler(Visit &visit, unsigned threads)
+                : m_visit(visit)
+                , m_queues(threads)
+                , m_pending(0)
+                , m_idle(0)
+                , m_failed(false)
+            {
+            }
+
+            // Visit all descendants of root, calling visit(node, thread) with thread from 0 to number of threads minus 1
+            void run(xml_node<Ch> *root)
+            {
+                if (!root->first_node())
+                    return;
+                split(0, root, count_children(root));
+                std::vector<std::thread> workers;
+                for (unsigned thread = 1; thread < m_queues.size(); ++thread)
+                    workers.emplace_back(&subtree_scheduler::work, this, thread);
+                work(0);
+                for (std::thread &worker: workers)
+                    worker.join();
+#if !defined(RAPIDXML_NO_EXCEPTIONS)
+                if (m_error)
+                    std::rethrow_exception(m_error);
+#endif
+            }
+
+        private:
+
+            struct task
+            {
+                xml_node<Ch> *first;        // First sibling of the range
+                std::size_t count;          // Number of siblings in the range
+            };
+
+            struct queue
+            {
+                std::mutex mutex;
+                std::deque<task> tasks;
+            };
+
+            void push(unsigned thread, task t)
+            {
+                m_pending.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(m_queues[thread].mutex);
+                m_queues[thread].tasks.push_back(t);
+            }
+
+            bool pop(unsigned thread, task &t)
+            {
+                std::lock_guard<std::mutex> lock(m_queues[thread].mutex);
+                if (m_queues[thread].tasks.empty())
+                    return false;
+                t = m_queues[thread].tasks.back();
+                m_queues[thread].tasks.pop_back();
+                return true;
+            }
+
+            bool steal(unsigned thread, task &t)
+            {
+                for (std::size_t i = 1; i < m_queues.size(); ++i)
+                {
+                    queue &victim = m_queues[(thread + i) % m_queues.size()];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.tasks.empty())
+                    {
+                        t = victim.tasks.front();
+                        victim.tasks.pop_front();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Count children of node, stopping at parallel_split unless counts are kept, so that wide nodes are not walked just to count them
+            static std::size_t count_children(const xml_node<Ch> *node)
+            {
+#ifdef RAPIDXML_NODE_COUNTS
+                return node->child_count();
+#else
+                std::size_t count = 0;
+                for (xml_node<Ch> *child = node->first_node(); child && count < parallel_split; child = child->next_sibling())
+                    ++count;
+                return count;
+#endif
+            }
+
+            // Push children of node as tasks, given their count as returned by count_children()
+            void split(unsigned thread, xml_node<Ch> *node, std::size_t count)
+            {
+                std::size_t grain = count >= parallel_split ? parallel_grain : (count + 1) / 2;
+                xml_node<Ch> *first = node->first_node();
+                while (first)
+                {
+                    // Find first sibling of next task
+                    xml_node<Ch> *next = first;
+                    std::size_t size = 0;
+                    for (; next && size < grain; ++size)
+                        next = next->next_sibling();
+                    push(thread, task{ first, size });
+                    first = next;
+                }
+            }
+
+            // Check if children of node should be split off into tasks, and split them if so
+            bool split_off(unsigned thread, xml_node<Ch> *node)
+            {
+                std::size_t count = count_children(node);
+                if (count < parallel_split && !(count > 1 && m_idle.load(std::memory_order_relaxed) > 0))
+                    return false;
+                split(thread, node, count);
+                return true;
+            }
+
+            // Visit subtree of root in document order, except for subtrees split off into tasks
+            void visit_subtree(unsigned thread, xml_node<Ch> *root)
+            {
+                xml_node<Ch> *node = root;
+                while (true)
+                {
+                    m_visit(*node, thread);
+                    if (node->first_node() && !split_off(thread, node))
+                    {
+                        node = node->first_node();
+                        continue;
+                    }
+                    while (node != root && !node->next_sibling())
+                        node = node->parent();
+                    if (node == root)
+                        return;
+                    node = node->next_sibling();
+                }
+            }
+
+            void execute(unsigned thread, const task &t)
+            {
+                xml_node<Ch> *node = t.first;
+                for (std::size_t i = 0; i < t.count; ++i)
+                {
+                    visit_subtree(thread, node);
+                    node = node->next_sibling();
+                }
+            }
+
+            void work(unsigned thread)
+            {
+                bool idle = false;
+                task t;
+                while (!m_failed.load(std::memory_order_relaxed))
+                {
+                    if (pop(thread, t) || steal(thread, t))
+                    {
+                        if (idle)
+                        {
+                            m_idle.fetch_sub(1, std::memory_order_relaxed);
+                            idle = false;
+                        }
+#if defined(RAPIDXML_NO_EXCEPTIONS)
+                        execute(thread, t);
+#else
+                        try
+                        {
+                            execute(thread, t);
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> lock(m_error_mutex);
+                            if (!m_error)
+                                m_error = std::current_exception();
+                            m_failed.store(true, std::memory_order_relaxed);
+                        }
+#endif
+                        // Tasks split off by this one were counted before it completes, so pending count only drops to 0 when all work is done
+                        m_pending.fetch_sub(1, std::memory_order_acq_rel);
+                    }
+                    else if (m_pending.load(std::memory_order_acquire) == 0)
+                        break;
+                    else
+                    {
+                        if (!idle)
+                        {
+                            m_idle.fetch_add(1, std::memory_order_relaxed);
+                            idle = true;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+                if (idle)
+                    m_idle.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            Visit &m_visit;
+            std::vector<queue> m_queues;                // Task queue of each thread
+            std::atomic<std::size_t> m_pending;         // Number of tasks queued or running
+            std::atomic<unsigned> m_idle;               // Number of threads looking for tasks
+            std::atomic<bool> m_failed;                 // Whether a visit threw an exception
+#if !defined(RAPIDXML_NO_EXCEPTIONS)
+            std::mutex m_error_mutex;
+            std::exception_ptr m_error;                 // First exception thrown by a visit
+#endif
+
+        };
+
+        // Memory resource handing out memory of a memory_pool to several sub-pools, one allocation at a time.
+        // Memory stays allocated until the pool is cleared; deallocation does nothing.
+        template<class Ch>
+        class pool_resource: public std::pmr::memory_resource
+        {
+
+        public:
+
+            explicit pool_resource(memory_pool<Ch> &pool)
+                : m_pool(pool)
+            {
+            }
+
+        private:
+
+            void *do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                assert(alignment <= RAPIDXML_ALIGNMENT);
+                (void)alignment;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_pool.allocate_string(0, (bytes + sizeof(Ch) - 1) / sizeof(Ch));
+            }
+
+            void do_deallocate(void *, std::size_t, std::size_t) override
+            {
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+            {
+                return this == &other;
+            }
+
+            memory_pool<Ch> &m_pool;
+            std::mutex m_mutex;
+
+        };
+
+        inline unsigned parallel_threads(unsigned threads)
+        {
+            return threads == 0 ? (std::max)(1u, std::thread::hardware_concurrency()) : threads;
+        }
+
+    }
+    //! \endcond
+
+    //! Calls a function for each descendant of a node, on several threads at once.
+    //! The tree is split into tasks, each a range of siblings with their subtrees, which idle threads steal from busy ones;
+    //! children of wide nodes are handed out in tasks by the thread which visited the node, in a single walk over them,
+    //! and children of other nodes are counted only up to the number at which they are split, unless <code>RAPIDXML_NODE_COUNTS</code> is defined.
+    //! Nodes are visited in no particular order, except that each thread visits nodes of a task in document order.
+    //! <br><br>
+    //! Tree is only read while visiting, so visits do not race with each other as long as the function does not modify the tree;
+    //! data written by the function itself must be synchronized by the function, or kept separate for each thread.
+    //! If the function throws, remaining visits are abandoned, and the first exception is rethrown once all threads have stopped.
+    //! \param root Node whose descendants are visited; root itself is not visited.
+    //! \param fn Function called as <code>fn(xml_node<Ch> &node)</code>.
+    //! \param threads Number of threads to use, including the calling thread, or 0 to use one thread per hardware thread.
+    template<class Ch, class Function>
+    void parallel_for_each_descendant(xml_node<Ch> *root, Function fn, unsigned threads = 0)
+    {
+        auto visit = [&fn](xml_node<Ch> &node, unsigned) { fn(node); };
+        internal::subtree_scheduler<Ch, decltype(visit)> scheduler(visit, internal::parallel_threads(threads));
+        scheduler.run(root);
+    }
+
+    //! Calls a function for each descendant of a node, on several threads at once, allowing the function to modify the visited subtree.
+    //! Nodes are split into tasks as by parallel_for_each_descendant(), and each node is visited before its children,
+    //! so the function may change name, value and attributes of the node it is called on, and add, remove or modify its descendants;
+    //! descendants it adds are visited as well.
+    //! It must not modify any other node, including siblings and ancestors of the visited node, nor remove the visited node from its parent.
+    //! <br><br>
+    //! New nodes, attributes and strings must be allocated from the memory_pool passed to the function,
+    //! which is a sub-pool of given pool owned by the calling thread, so no locking is needed for most allocations.
+    //! Sub-pools obtain their blocks from the pool, so everything allocated from them lives until the pool is cleared;
+    //! free lists of sub-pools are discarded at the end, so nodes freed to them are not reused.
+    //! <br><br>
+    //! If root belongs to a document, its updates are deferred while nodes are visited, see xml_document::defer_updates(),
+    //! so that its generation is advanced and its ID index rebuilt once at the end.
+    //! If the function throws, remaining visits are abandoned, and the first exception is rethrown once all threads have stopped.
+    //! \param root Node whose descendants are visited; root itself is not visited.
+    //! \param pool Memory pool of the tree, usually its document, from which sub-pools obtain their memory.
+    //! \param fn Function called as <code>fn(xml_node<Ch> &node, memory_pool<Ch> &pool)</code>.
+    //! \param threads Number of threads to use, including the calling thread, or 0 to use one thread per hardware thread.
+    template<class Ch, class Function>
+    void parallel_transform(xml_node<Ch> *root, memory_pool<Ch> &pool, Function fn, unsigned threads = 0)
+    {
+        threads = internal::parallel_threads(threads);
+        internal::pool_resource<Ch> resource(pool);
+        std::unique_ptr<memory_pool<Ch>[]> sub_pools(new memory_pool<Ch>[threads]);
+        for (unsigned thread = 0; thread < threads; ++thread)
+        {
+            sub_pools[thread].set_memory_resource(&resource);
+            sub_pools[thread].set_segregated_arenas(pool.segregated_arenas());
+        }
+
+        // Resume updates of the document even if the function throws
+        struct deferral
+        {
+            xml_document<Ch, 0> *doc;
+            ~deferral()
+            {
+                if (doc)
+                    doc->defer_updates(false);
+            }
+        } deferred = { root->document() };
+        if (deferred.doc && deferred.doc->updates_deferred())
+            deferred.doc = 0;
+        if (deferred.doc)
+            deferred.doc->defer_updates(true);
+
+        auto visit = [&fn, &sub_pools](xml_node<Ch> &node, unsigned thread) { fn(node, sub_pools[thread]); };
+        internal::subtree_scheduler<Ch, decltype(visit)> scheduler(visit, threads);
+        scheduler.run(root);
+    }
+
+}
+
+#endif
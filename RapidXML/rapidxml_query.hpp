@@ -0,0 +1,767 @@
+#ifndef RAPIDXML_QUERY_HPP_INCLUDED
+#define RAPIDXML_QUERY_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_query.hpp This file contains xml_query, which compiles a subset of XPath
+//! into a plan that is executed over node trees without allocating memory
+
+#include "rapidxml.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rapidxml
+{
+
+    //! Path query compiled once from a subset of XPath, and executed any number of times over trees of nodes.
+    //! Supported syntax:
+    //! <ul>
+    //! <li><code>/</code> at the beginning selects the document of context node; otherwise path is relative to context node.</li>
+    //! <li><code>A/B</code> selects child elements named B; <code>A//B</code> selects descendant elements named B.</li>
+    //! <li><code>*</code> matches elements with any name; <code>text()</code>, allowed as last step only, selects data and CDATA children.</li>
+    //! <li><code>[n]</code> keeps n-th node, counting from 1, among nodes selected from the same parent.</li>
+    //! <li><code>[\@a]</code> and <code>[\@a='v']</code> keep elements having attribute a, or having it with value v.</li>
+    //! <li><code>[C]</code> and <code>[C='v']</code> keep elements having child element C, or having it with value v;
+    //! <code>[text()='v']</code> keeps elements whose value is v. Values may be quoted with ' or ".</li>
+    //! </ul>
+    //! Several predicates of a step are applied in order, so <code>Item[\@id][2]</code> selects second item with an id.
+    //! Names are compared case-sensitively. Nodes are selected in document order for each node matching the previous step;
+    //! a node reachable through two different nodes matching a previous step, as in <code>//A//B</code> with nested A elements, is selected twice.
+    //! <br><br>
+    //! Query is executed by recursing over steps and walking children and descendants through node links, so no memory is allocated,
+    //! and child name tests use xml_node::first_node() and xml_node::next_sibling(), which benefit from name hashes and child indexes.
+    //! Query owns a copy of its text, so it does not refer to the string it was compiled from.
+    //! Syntax errors are reported like parse errors, with parse_error::where() pointing into the compiled string.
+    //! \param Ch Character type to use.
+    template<class Ch = char>
+    class xml_query
+    {
+
+    public:
+
+        //! Maximum number of predicates of a single step.
+        static const std::size_t max_predicates = 8;
+
+        //! Compiles query.
+        //! \param path Query text; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of query text, in characters, or 0 to have size calculated automatically from string.
+        explicit xml_query(const Ch *path, std::size_t size = 0)
+            : m_text(path, size ? size : internal::measure(path))
+            , m_absolute(false)
+        {
+            compile(path);
+            m_hash = internal::hash(m_text.data(), m_text.size());
+        }
+
+        //! Calls a function for each node selected by the query, in order of selection.
+        //! The function is called with pointer to xml_node; if it returns bool, returning false stops the query.
+        //! The tree must not be modified by the function.
+        //! \param context Context node, relative to which the query is executed.
+        //! \param fn Function to call.
+        //! \return False if the query was stopped by the function, true otherwise.
+        template<class Fn>
+        bool for_each(xml_node<Ch> *context, Fn fn) const
+        {
+            assert(context);
+            if (m_absolute)
+            {
+                context = context->document();
+                if (!context)
+                    return true;
+            }
+            return match(0, context, fn);
+        }
+
+        //! Finds first node selected by the query.
+        //! \param context Context node, relative to which the query is executed.
+        //! \return Pointer to first selected node, or 0 if none.
+        xml_node<Ch> *first(xml_node<Ch> *context) const
+        {
+            xml_node<Ch> *result = 0;
+            for_each(context, [&result](xml_node<Ch> *node) { result = node; return false; });
+            return result;
+        }
+
+        //! Counts nodes selected by the query.
+        //! \param context Context node, relative to which the query is executed.
+        //! \return Number of selected nodes.
+        std::size_t count(xml_node<Ch> *context) const
+        {
+            std::size_t result = 0;
+            for_each(context, [&result](xml_node<Ch> *) { ++result; });
+            return result;
+        }
+
+        //! Gets text the query was compiled from.
+        //! \return Pointer to query text, which is not zero-terminated.
+        const Ch *text() const
+        {
+            return m_text.data();
+        }
+
+        //! Gets size of text the query was compiled from.
+        //! \return Size of query text, in characters.
+        std::size_t text_size() const
+        {
+            return m_text.size();
+        }
+
+        //! Gets hash of text the query was compiled from.
+        //! \return 32-bit hash of query text.
+        std::uint32_t hash() const
+        {
+            return m_hash;
+        }
+
+        //! Gets number of steps of the compiled query.
+        //! \return Number of steps.
+        std::size_t step_count() const
+        {
+            return m_steps.size();
+        }
+
+    private:
+
+        enum axis_kind
+        {
+            axis_child,         // Children of context node
+            axis_descendant     // Children of context node and of its descendants
+        };
+
+        enum test_kind
+        {
+            test_name,          // Elements with given name
+            test_any,           // All elements
+            test_text           // Data and CDATA nodes
+        };
+
+        enum predicate_kind
+        {
+            predicate_position,             // Position among nodes selected from the same parent
+            predicate_attribute,            // Attribute exists
+            predicate_attribute_value,      // Attribute has given value
+            predicate_child,                // Child element exists
+            predicate_child_value,          // Child element has given value
+            predicate_value                 // Element has given value
+        };
+
+        struct predicate
+        {
+            predicate_kind kind;
+            std::size_t position;           // Position, counting from 1
+            std::size_t name;               // Offset of name in query text
+            std::size_t name_size;          // Size of name
+            std::size_t value;              // Offset of value in query text
+            std::size_t value_size;         // Size of value
+        };
+
+        struct step
+        {
+            axis_kind axis;
+            test_kind test;
+            std::size_t name;               // Offset of name in query text
+            std::size_t name_size;          // Size of name
+            std::size_t first_predicate;    // Index of first predicate in m_predicates
+            std::size_t predicate_count;    // Number of predicates
+        };
+
+        ///////////////////////////////////////////////////////////////////////
+        // Compilation
+
+        static bool is_whitespace(Ch ch)
+        {
+            return static_cast<unsigned char>(ch) == ch && internal::lookup_tables<0>::lookup_whitespace[static_cast<unsigned char>(ch)];
+        }
+
+        static bool is_name_char(Ch ch)
+        {
+            switch (ch)
+            {
+            case Ch('/'): case Ch('['): case Ch(']'): case Ch('='): case Ch('@'): case Ch('\''): case Ch('"'): case Ch('('): case Ch(')'): case Ch('*'):
+                return false;
+            default:
+                return !is_whitespace(ch);
+            }
+        }
+
+        // Where pointer for errors, within the string the query was compiled from
+        static void *where(const Ch *path, std::size_t offset)
+        {
+            return const_cast<Ch *>(path + offset);
+        }
+
+        // Report syntax error the same way as parse errors
+        static void syntax_error(const char *what, void *where)
+        {
+#if defined(RAPIDXML_NO_EXCEPTIONS)
+            parse_error_handler(what, where);
+            assert(0);
+#else
+            throw parse_error(what, where);
+#endif
+        }
+
+        void skip_whitespace(std::size_t &pos) const
+        {
+            while (pos < m_text.size() && is_whitespace(m_text[pos]))
+                ++pos;
+        }
+
+        bool skip_literal(std::size_t &pos, const char *literal) const
+        {
+            std::size_t end = pos;
+            for (; *literal; ++literal, ++end)
+                if (end >= m_text.size() || m_text[end] != Ch(*literal))
+                    return false;
+            pos = end;
+            return true;
+        }
+
+        std::size_t skip_name(std::size_t &pos) const
+        {
+            std::size_t begin = pos;
+            while (pos < m_text.size() && is_name_char(m_text[pos]))
+                ++pos;
+            return pos - begin;
+        }
+
+        void compile(const Ch *path)
+        {
+            std::size_t pos = 0;
+            axis_kind axis = axis_child;
+            if (skip_literal(pos, "//"))
+            {
+                m_absolute = true;
+                axis = axis_descendant;
+            }
+            else if (skip_literal(pos, "/"))
+                m_absolute = true;
+
+            for (;;)
+            {
+                step s;
+                s.axis = axis;
+                s.name = pos;
+                s.name_size = 0;
+                s.first_predicate = m_predicates.size();
+                s.predicate_count = 0;
+
+                // Node test
+                if (!m_steps.empty() && m_steps.back().test == test_text)
+                    syntax_error("text() must be last step", where(path, pos));
+                if (skip_literal(pos, "text()"))
+                    s.test = test_text;
+                else if (skip_literal(pos, "*"))
+                    s.test = test_any;
+                else
+                {
+                    s.test = test_name;
+                    s.name_size = skip_name(pos);
+                    if (s.name_size == 0)
+                        syntax_error("expected name", where(path, pos));
+                }
+
+                // Predicates
+                while (skip_literal(pos, "["))
+                {
+                    if (s.predicate_count == max_predicates)
+                        syntax_error("too many predicates", where(path, pos));
+                    skip_whitespace(pos);
+                    m_predicates.push_back(compile_predicate(path, pos));
+                    ++s.predicate_count;
+                    skip_whitespace(pos);
+                    if (!skip_literal(pos, "]"))
+                        syntax_error("expected ]", where(path, pos));
+                }
+                m_steps.push_back(s);
+
+                // Separator
+                if (pos == m_text.size())
+                    break;
+                if (skip_literal(pos, "//"))
+                    axis = axis_descendant;
+                else if (skip_literal(pos, "/"))
+                    axis = axis_child;
+                else
+                    syntax_error("expected /", where(path, pos));
+            }
+        }
+
+        predicate compile_predicate(const Ch *path, std::size_t &pos)
+        {
+            predicate p = predicate();
+            if (pos < m_text.size() && m_text[pos] >= Ch('0') && m_text[pos] <= Ch('9'))
+            {
+                p.kind = predicate_position;
+                while (pos < m_text.size() && m_text[pos] >= Ch('0') && m_text[pos] <= Ch('9'))
+                    p.position = p.position * 10 + static_cast<std::size_t>(m_text[pos++] - Ch('0'));
+                if (p.position == 0)
+                    syntax_error("position must be at least 1", where(path, pos));
+                return p;
+            }
+
+            // Attribute, child element or own value, optionally compared with a value
+            bool attribute = skip_literal(pos, "@");
+            bool value = !attribute && skip_literal(pos, "text()");
+            p.name = pos;
+            if (!value)
+            {
+                p.name_size = skip_name(pos);
+                if (p.name_size == 0)
+                    syntax_error("expected name", where(path, pos));
+            }
+            skip_whitespace(pos);
+            if (!skip_literal(pos, "="))
+            {
+                if (value)
+                    syntax_error("expected =", where(path, pos));
+                p.kind = attribute ? predicate_attribute : predicate_child;
+                return p;
+            }
+            p.kind = attribute ? predicate_attribute_value : value ? predicate_value : predicate_child_value;
+            skip_whitespace(pos);
+            Ch quote = pos < m_text.size() ? m_text[pos] : Ch(0);
+            if (quote != Ch('\'') && quote != Ch('"'))
+                syntax_error("expected ' or \"", where(path, pos));
+            p.value = ++pos;
+            while (pos < m_text.size() && m_text[pos] != quote)
+                ++pos;
+            if (pos == m_text.size())
+                syntax_error("expected ' or \"", where(path, pos));
+            p.value_size = pos++ - p.value;
+            return p;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // Execution
+
+        template<class Fn>
+        static bool emit(Fn &fn, xml_node<Ch> *node)
+        {
+            if constexpr (std::is_void_v<decltype(fn(node))>)
+            {
+                fn(node);
+                return true;
+            }
+            else
+                return fn(node);
+        }
+
+        // Next node in document order, within tree of root
+        static xml_node<Ch> *next(xml_node<Ch> *root, xml_node<Ch> *node)
+        {
+            if (node->first_node())
+                return node->first_node();
+            while (node != root && !node->next_sibling())
+                node = node->parent();
+            return node == root ? 0 : node->next_sibling();
+        }
+
+        // Match step with given index and following steps against context node
+        template<class Fn>
+        bool match(std::size_t index, xml_node<Ch> *context, Fn &fn) const
+        {
+            if (index == m_steps.size())
+                return emit(fn, context);
+            if (m_steps[index].axis == axis_child)
+                return match_children(index, context, fn);
+            for (xml_node<Ch> *node = context; node; node = next(context, node))
+                if (node->type() == node_type::node_element || node->type() == node_type::node_document)
+                    if (!match_children(index, node, fn))
+                        return false;
+            return true;
+        }
+
+        // Match step with given index against children of parent, and following steps against selected children
+        template<class Fn>
+        bool match_children(std::size_t index, xml_node<Ch> *parent, Fn &fn) const
+        {
+            const step &s = m_steps[index];
+            std::size_t positions[max_predicates] = {};
+            if (s.test == test_name)
+            {
+                const Ch *name = m_text.data() + s.name;
+                for (xml_node<Ch> *child = parent->first_node(name, s.name_size); child; child = child->next_sibling(name, s.name_size))
+                    if (child->type() == node_type::node_element)
+                    {
+                        bool exhausted = false;
+                        if (passes(s, child, positions, exhausted) && !match(index + 1, child, fn))
+                            return false;
+                        if (exhausted)
+                            break;
+                    }
+            }
+            else
+            {
+                for (xml_node<Ch> *child = parent->first_node(); child; child = child->next_sibling())
+                {
+                    node_type type = child->type();
+                    if (s.test == test_any ? type != node_type::node_element : type != node_type::node_data && type != node_type::node_cdata)
+                        continue;
+                    bool exhausted = false;
+                    if (passes(s, child, positions, exhausted) && !match(index + 1, child, fn))
+                        return false;
+                    if (exhausted)
+                        break;
+                }
+            }
+            return true;
+        }
+
+        // Apply predicates of step to node; set exhausted if no further sibling can pass
+        bool passes(const step &s, xml_node<Ch> *node, std::size_t *positions, bool &exhausted) const
+        {
+            for (std::size_t i = 0; i < s.predicate_count; ++i)
+            {
+                const predicate &p = m_predicates[s.first_predicate + i];
+                const Ch *name = m_text.data() + p.name;
+                const Ch *value = m_text.data() + p.value;
+                switch (p.kind)
+                {
+                case predicate_position:
+                    if (++positions[i] != p.position)
+                    {
+                        exhausted = i == 0 && positions[i] > p.position;
+                        return false;
+                    }
+                    exhausted = i == 0;
+                    break;
+                case predicate_attribute:
+                    if (!node->first_attribute(name, p.name_size))
+                        return false;
+                    break;
+                case predicate_attribute_value:
+                {
+                    xml_attribute<Ch> *attribute = node->first_attribute(name, p.name_size);
+                    if (!attribute || !internal::compare(attribute->value(), attribute->value_size(), value, p.value_size, true))
+                        return false;
+                    break;
+                }
+                case predicate_child:
+                    if (!node->first_node(name, p.name_size))
+                        return false;
+                    break;
+                case predicate_child_value:
+                {
+                    xml_node<Ch> *child = node->first_node(name, p.name_size);
+                    if (!child || !internal::compare(child->value(), child->value_size(), value, p.value_size, true))
+                        return false;
+                    break;
+                }
+                case predicate_value:
+                    if (!internal::compare(node->value(), node->value_size(), value, p.value_size, true))
+                        return false;
+                    break;
+                }
+            }
+            return true;
+        }
+
+        std::basic_string<Ch> m_text;               // Query text, to which names and values of steps refer
+        std::vector<step> m_steps;                  // Steps, in order
+        std::vector<predicate> m_predicates;        // Predicates of all steps
+        bool m_absolute;                            // Whether query starts at document of context node
+        std::uint32_t m_hash;                       // Hash of query text
+
+    };
+
+    //! Cache of results of queries executed over a document, for documents which are queried repeatedly with the same queries.
+    //! Results are stored the first time a query is executed from a context node, and returned without executing the query afterwards.
+    //! Cache is emptied automatically when the document is modified, as tracked by xml_document::generation().
+    //! <br><br>
+    //! Results are keyed by query text and context node, so equal queries compiled separately share results.
+    //! Memory for results is allocated from a monotonic buffer, which is released when the cache is emptied.
+    //! \param Ch Character type to use.
+    template<class Ch = char>
+    class xml_query_cache
+    {
+
+    public:
+
+        //! Nodes selected by a query, in order of selection.
+        //! Result remains valid until the cache is emptied, that is until the document is modified or the cache is cleared.
+        class result
+        {
+
+        public:
+
+            //! Gets iterator to first selected node.
+            xml_node<Ch> *const *begin() const
+            {
+                return m_nodes;
+            }
+
+            //! Gets iterator past last selected node.
+            xml_node<Ch> *const *end() const
+            {
+                return m_nodes + m_size;
+            }
+
+            //! Gets number of selected nodes.
+            std::size_t size() const
+            {
+                return m_size;
+            }
+
+            //! Checks if no nodes were selected.
+            bool empty() const
+            {
+                return m_size == 0;
+            }
+
+            //! Gets selected node.
+            //! \param index Index of node, less than size().
+            xml_node<Ch> *operator [](std::size_t index) const
+            {
+                assert(index < m_size);
+                return m_nodes[index];
+            }
+
+        private:
+
+            friend class xml_query_cache;
+
+            result(xml_node<Ch> *const *nodes, std::size_t size)
+                : m_nodes(nodes)
+                , m_size(size)
+            {
+            }
+
+            xml_node<Ch> *const *m_nodes;
+            std::size_t m_size;
+
+        };
+
+        //! Constructs empty cache for a document.
+        //! \param document Document whose queries are cached; it must outlive the cache.
+        //! \param upstream Memory resource from which the monotonic buffer allocates, or 0 to use global <code>new</code> and <code>delete</code>.
+        explicit xml_query_cache(const xml_document<Ch, 0> &document, std::pmr::memory_resource *upstream = 0)
+            : m_document(&document)
+            , m_generation(document.generation())
+            , m_memory(upstream ? upstream : std::pmr::new_delete_resource())
+            , m_entries(0)
+            , m_slot_count(0)
+            , m_count(0)
+        {
+        }
+
+        //! Gets nodes selected by a query, executing the query only if its result is not cached.
+        //! \param query Query to execute.
+        //! \param context Context node, relative to which the query is executed; it must belong to the document of the cache.
+        //! \return Selected nodes.
+        result select(const xml_query<Ch> &query, xml_node<Ch> *context)
+        {
+            assert(context);
+            if (m_generation != m_document->generation())
+                clear();
+
+            // Look cached result up
+            std::uint32_t hash = query.hash() ^ static_cast<std::uint32_t>(reinterpret_cast<std::size_t>(context) >> 4);
+            std::size_t slot = m_slot_count ? probe(query, context, hash) : 0;
+            if (m_slot_count && m_entries[slot].text)
+                return result(m_entries[slot].nodes, m_entries[slot].size);
+
+            // Execute query and store result
+            m_scratch.clear();
+            query.for_each(context, [this](xml_node<Ch> *node) { m_scratch.push_back(node); });
+            if (2 * (m_count + 1) > m_slot_count)
+            {
+                grow();
+                slot = probe(query, context, hash);
+            }
+            entry &e = m_entries[slot];
+            e.text = static_cast<Ch *>(m_memory.allocate(query.text_size() * sizeof(Ch), alignof(Ch)));
+            std::memcpy(e.text, query.text(), query.text_size() * sizeof(Ch));
+            e.text_size = query.text_size();
+            e.context = context;
+            e.hash = hash;
+            e.size = m_scratch.size();
+            e.nodes = static_cast<xml_node<Ch> **>(m_memory.allocate((e.size ? e.size : 1) * sizeof(xml_node<Ch> *), alignof(xml_node<Ch> *)));
+            std::copy(m_scratch.begin(), m_scratch.end(), e.nodes);
+            ++m_count;
+            return result(e.nodes, e.size);
+        }
+
+        //! Gets first node selected by a query, executing the query only if its result is not cached.
+        //! \param query Query to execute.
+        //! \param context Context node, relative to which the query is executed.
+        //! \return Pointer to first selected node, or 0 if none.
+        xml_node<Ch> *first(const xml_query<Ch> &query, xml_node<Ch> *context)
+        {
+            result r = select(query, context);
+            return r.empty() ? 0 : r[0];
+        }
+
+        //! Gets number of cached results which are valid for current generation of the document.
+        //! \return Number of results.
+        std::size_t size() const
+        {
+            return m_generation == m_document->generation() ? m_count : 0;
+        }
+
+        //! Removes all cached results, and releases their memory.
+        void clear()
+        {
+            m_memory.release();
+            m_entries = 0;
+            m_slot_count = 0;
+            m_count = 0;
+            m_generation = m_document->generation();
+        }
+
+    private:
+
+        struct entry
+        {
+            Ch *text;                       // Copy of query text, or 0 if slot is empty
+            std::size_t text_size;          // Size of query text
+            xml_node<Ch> *context;          // Context node
+            std::uint32_t hash;             // Hash of query text and context node
+            xml_node<Ch> **nodes;           // Selected nodes
+            std::size_t size;               // Number of selected nodes
+        };
+
+        // No copying
+        xml_query_cache(const xml_query_cache &);
+        void operator =(const xml_query_cache &);
+
+        // Find slot holding result of query, or empty slot where it belongs
+        std::size_t probe(const xml_query<Ch> &query, xml_node<Ch> *context, std::uint32_t hash) const
+        {
+            std::size_t mask = m_slot_count - 1;
+            std::size_t slot = hash & mask;
+            for (; m_entries[slot].text; slot = (slot + 1) & mask)
+            {
+                const entry &e = m_entries[slot];
+                if (e.hash == hash && e.context == context && 
+                    internal::compare(e.text, e.text_size, query.text(), query.text_size(), true))
+                    break;
+            }
+            return slot;
+        }
+
+        // Double number of slots; old slots stay in the monotonic buffer until it is released
+        void grow()
+        {
+            std::size_t slot_count = m_slot_count ? 2 * m_slot_count : 64;
+            entry *entries = static_cast<entry *>(m_memory.allocate(slot_count * sizeof(entry), alignof(entry)));
+            for (std::size_t slot = 0; slot < slot_count; ++slot)
+                entries[slot].text = 0;
+            for (std::size_t i = 0; i < m_slot_count; ++i)
+                if (m_entries[i].text)
+                {
+                    std::size_t slot = m_entries[i].hash & (slot_count - 1);
+                    while (entries[slot].text)
+                        slot = (slot + 1) & (slot_count - 1);
+                    entries[slot] = m_entries[i];
+                }
+            m_entries = entries;
+            m_slot_count = slot_count;
+        }
+
+        const xml_document<Ch, 0> *m_document;             // Document whose queries are cached
+        std::size_t m_generation;                       // Generation of document the cached results belong to
+        std::pmr::monotonic_buffer_resource m_memory;   // Memory for slots, query texts and results
+        entry *m_entries;                               // Open addressing hash table of results
+        std::size_t m_slot_count;                       // Number of slots, a power of 2, or 0 if none
+        std::size_t m_count;                            // Number of cached results
+        std::vector<xml_node<Ch> *> m_scratch;          // Nodes collected while executing a query, reused between queries
+
+    };
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+
+    //! \cond internal
+    namespace internal
+    {
+
+        // Path passed as template argument, parsed into steps at compile time
+        template<class Ch, std::size_t N>
+        struct static_path
+        {
+
+            constexpr static_path(const Ch (&path)[N])
+                : text()
+                , absolute(N > 1 && path[0] == Ch('/'))
+                , count(0)
+                , offsets()
+                , sizes()
+                , hashes()
+            {
+                for (std::size_t i = 0; i < N; ++i)
+                    text[i] = path[i];
+                std::size_t pos = absolute ? 1 : 0;
+                for (;;)
+                {
+                    std::size_t begin = pos;
+                    while (pos < N - 1 && text[pos] != Ch('/'))
+                        ++pos;
+                    if (pos == begin)
+                        empty_step();
+                    offsets[count] = begin;
+                    sizes[count] = pos - begin;
+                    hashes[count] = hash(text + begin, pos - begin);
+                    ++count;
+                    if (pos == N - 1)
+                        break;
+                    ++pos;
+                }
+            }
+
+            // Not constexpr, so that paths with empty steps fail to compile
+            static void empty_step()
+            {
+                assert(0);
+            }
+
+            Ch text[N];                     // Path, zero-terminated
+            bool absolute;                  // Whether path starts at document
+            std::size_t count;              // Number of steps
+            std::size_t offsets[N];         // Offset of name of each step
+            std::size_t sizes[N];           // Size of name of each step
+            std::uint32_t hashes[N];        // Hash of name of each step
+
+        };
+
+        template<static_path Path, class Ch, std::size_t... Steps>
+        xml_node<Ch> *select_steps(xml_node<Ch> *node, std::index_sequence<Steps...>)
+        {
+            ((node = node ? node->first_node_hashed(Path.text + Path.offsets[Steps], Path.sizes[Steps], Path.hashes[Steps]) : 0), ...);
+            return node;
+        }
+
+    }
+    //! \endcond
+
+    //! Finds node by a path of element names separated by <code>/</code>, parsed at compile time, such as <code>select<"Root/Items/Item">(doc)</code>.
+    //! Result is the same as of a chain of xml_node::first_node() calls, one for each name: at each step, first child with the name is taken.
+    //! Path starting with <code>/</code> is followed from the document of the node, otherwise from the node itself.
+    //! Sizes and hashes of names are computed during compilation, and the traversal is unrolled, so nothing about the path is computed at run time.
+    //! Use xml_query for paths that are not known at compile time or need predicates.
+    //! <br><br>
+    //! Requires C++20, which allows string literals as template arguments.
+    //! \param Path Path of element names; empty names, as in <code>"A//B"</code>, fail to compile.
+    //! \param node Node to follow the path from.
+    //! \return Pointer to found node, or 0 if not found.
+    template<internal::static_path Path, class Ch>
+    xml_node<Ch> *select(xml_node<Ch> *node)
+    {
+        constexpr std::size_t count = Path.count;
+        if constexpr (Path.absolute)
+            if (!(node = node->document()))
+                return 0;
+        return internal::select_steps<Path>(node, std::make_index_sequence<count>());
+    }
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,406 @@
+#ifndef RAPIDXML_RANGES_HPP_INCLUDED
+#define RAPIDXML_RANGES_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_ranges.hpp This file contains C++20 range views of children, attributes and descendants of nodes
+
+#include "rapidxml.hpp"
+#include "rapidxml_iterators.hpp"
+
+#if defined(__has_include)
+    #if __has_include(<version>)
+        #include <version>
+    #endif
+#endif
+
+#if defined(__cpp_lib_ranges) && __cpp_lib_ranges >= 201911L
+
+#include <ranges>
+
+namespace rapidxml
+{
+
+    //! Bidirectional view of children of a node, optionally only those with given name.
+    //! Elements of the view are xml_node references; the view refers to the node, and can be copied freely.
+    //! Use children() to create it.
+    template<class Ch>
+    class child_view: public std::ranges::view_interface<child_view<Ch>>
+    {
+
+    public:
+
+        //! Iterator of child_view.
+        class iterator
+        {
+
+        public:
+
+            typedef xml_node<Ch> value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::bidirectional_iterator_tag iterator_category;
+
+            iterator()
+                : m_parent(0)
+                , m_node(0)
+                , m_name(0)
+                , m_name_size(0)
+            {
+            }
+
+            xml_node<Ch> &operator *() const
+            {
+                assert(m_node);
+                return *m_node;
+            }
+
+            xml_node<Ch> *operator->() const
+            {
+                assert(m_node);
+                return m_node;
+            }
+
+            iterator &operator++()
+            {
+                assert(m_node);
+                m_node = m_node->next_sibling(m_name, m_name_size);
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            iterator &operator--()
+            {
+                m_node = m_node ? m_node->previous_sibling(m_name, m_name_size) : m_parent->last_node(m_name, m_name_size);
+                assert(m_node);
+                return *this;
+            }
+
+            iterator operator--(int)
+            {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            bool operator ==(const iterator &rhs) const
+            {
+                return m_node == rhs.m_node;
+            }
+
+        private:
+
+            friend class child_view;
+
+            iterator(xml_node<Ch> *parent, xml_node<Ch> *node, const Ch *name, std::size_t name_size)
+                : m_parent(parent)
+                , m_node(node)
+                , m_name(name)
+                , m_name_size(name_size)
+            {
+            }
+
+            xml_node<Ch> *m_parent;     // Node whose children are iterated, for decrementing end iterator
+            xml_node<Ch> *m_node;       // Current child, or 0 at the end
+            const Ch *m_name;           // Name of iterated children, or 0 if any name matches
+            std::size_t m_name_size;    // Size of name
+
+        };
+
+        child_view()
+            : m_parent(0)
+            , m_name(0)
+            , m_name_size(0)
+        {
+        }
+
+        //! Constructs view of children of a node.
+        //! \param parent Node whose children are viewed.
+        //! \param name Name of viewed children, or 0 to view all children; this string doesn't have to be zero-terminated if name_size is non-zero.
+        //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+        explicit child_view(xml_node<Ch> *parent, const Ch *name = 0, std::size_t name_size = 0)
+            : m_parent(parent)
+            , m_name(name)
+            , m_name_size(name && name_size == 0 ? internal::measure(name) : name_size)
+        {
+        }
+
+        iterator begin() const
+        {
+            return iterator(m_parent, m_parent->first_node(m_name, m_name_size), m_name, m_name_size);
+        }
+
+        iterator end() const
+        {
+            return iterator(m_parent, 0, m_name, m_name_size);
+        }
+
+    private:
+
+        xml_node<Ch> *m_parent;
+        const Ch *m_name;
+        std::size_t m_name_size;
+
+    };
+
+    //! Bidirectional view of attributes of a node, optionally only those with given name.
+    //! Elements of the view are xml_attribute references; the view refers to the node, and can be copied freely.
+    //! Use attributes() to create it.
+    template<class Ch>
+    class attribute_view: public std::ranges::view_interface<attribute_view<Ch>>
+    {
+
+    public:
+
+        //! Iterator of attribute_view.
+        class iterator
+        {
+
+        public:
+
+            typedef xml_attribute<Ch> value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::bidirectional_iterator_tag iterator_category;
+
+            iterator()
+                : m_node(0)
+                , m_attribute(0)
+                , m_name(0)
+                , m_name_size(0)
+            {
+            }
+
+            xml_attribute<Ch> &operator *() const
+            {
+                assert(m_attribute);
+                return *m_attribute;
+            }
+
+            xml_attribute<Ch> *operator->() const
+            {
+                assert(m_attribute);
+                return m_attribute;
+            }
+
+            iterator &operator++()
+            {
+                assert(m_attribute);
+                m_attribute = m_attribute->next_attribute(m_name, m_name_size);
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            iterator &operator--()
+            {
+                m_attribute = m_attribute ? m_attribute->previous_attribute(m_name, m_name_size) : m_node->last_attribute(m_name, m_name_size);
+                assert(m_attribute);
+                return *this;
+            }
+
+            iterator operator--(int)
+            {
+                iterator tmp = *this;
+                --*this;
+                return tmp;
+            }
+
+            bool operator ==(const iterator &rhs) const
+            {
+                return m_attribute == rhs.m_attribute;
+            }
+
+        private:
+
+            friend class attribute_view;
+
+            iterator(xml_node<Ch> *node, xml_attribute<Ch> *attribute, const Ch *name, std::size_t name_size)
+                : m_node(node)
+                , m_attribute(attribute)
+                , m_name(name)
+                , m_name_size(name_size)
+            {
+            }
+
+            xml_node<Ch> *m_node;               // Node whose attributes are iterated, for decrementing end iterator
+            xml_attribute<Ch> *m_attribute;     // Current attribute, or 0 at the end
+            const Ch *m_name;                   // Name of iterated attributes, or 0 if any name matches
+            std::size_t m_name_size;            // Size of name
+
+        };
+
+        attribute_view()
+            : m_node(0)
+            , m_name(0)
+            , m_name_size(0)
+        {
+        }
+
+        //! Constructs view of attributes of a node.
+        //! \param node Node whose attributes are viewed.
+        //! \param name Name of viewed attributes, or 0 to view all attributes; this string doesn't have to be zero-terminated if name_size is non-zero.
+        //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+        explicit attribute_view(xml_node<Ch> *node, const Ch *name = 0, std::size_t name_size = 0)
+            : m_node(node)
+            , m_name(name)
+            , m_name_size(name && name_size == 0 ? internal::measure(name) : name_size)
+        {
+        }
+
+        iterator begin() const
+        {
+            return iterator(m_node, m_node->first_attribute(m_name, m_name_size), m_name, m_name_size);
+        }
+
+        iterator end() const
+        {
+            return iterator(m_node, 0, m_name, m_name_size);
+        }
+
+    private:
+
+        xml_node<Ch> *m_node;
+        const Ch *m_name;
+        std::size_t m_name_size;
+
+    };
+
+    //! Forward view of descendants of a node in document order, optionally only those with given type and name; see descendant_iterator.
+    //! Elements of the view are xml_node references; the view refers to the node, and can be copied freely.
+    //! Use descendants() to create it.
+    template<class Ch>
+    class descendant_view: public std::ranges::view_interface<descendant_view<Ch>>
+    {
+
+    public:
+
+        typedef descendant_iterator<Ch> iterator;
+
+        descendant_view()
+            : m_root(0)
+            , m_name(0)
+            , m_name_size(0)
+            , m_type(node_type::node_element)
+            , m_match_type(false)
+        {
+        }
+
+        //! Constructs view of descendants of a node.
+        //! \param root Node whose descendants are viewed.
+        //! \param name Name of viewed descendants, or 0 to view descendants regardless of their name; this string doesn't have to be zero-terminated if name_size is non-zero.
+        //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+        explicit descendant_view(xml_node<Ch> *root, const Ch *name = 0, std::size_t name_size = 0)
+            : m_root(root)
+            , m_name(name)
+            , m_name_size(name && name_size == 0 ? internal::measure(name) : name_size)
+            , m_type(node_type::node_element)
+            , m_match_type(false)
+        {
+        }
+
+        //! Constructs view of descendants of a node of given type.
+        //! \param root Node whose descendants are viewed.
+        //! \param type Type of viewed descendants.
+        //! \param name Name of viewed descendants, or 0 to view descendants regardless of their name; this string doesn't have to be zero-terminated if name_size is non-zero.
+        //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+        descendant_view(xml_node<Ch> *root, node_type type, const Ch *name = 0, std::size_t name_size = 0)
+            : m_root(root)
+            , m_name(name)
+            , m_name_size(name && name_size == 0 ? internal::measure(name) : name_size)
+            , m_type(type)
+            , m_match_type(true)
+        {
+        }
+
+        iterator begin() const
+        {
+            return m_match_type ? iterator(m_root, m_type, m_name, m_name_size) : iterator(m_root, m_name, m_name_size);
+        }
+
+        iterator end() const
+        {
+            return iterator();
+        }
+
+    private:
+
+        xml_node<Ch> *m_root;
+        const Ch *m_name;
+        std::size_t m_name_size;
+        node_type m_type;
+        bool m_match_type;
+
+    };
+
+    //! Creates view of children of a node, usable with range algorithms and adaptors such as <code>std::views::filter</code>.
+    //! \param parent Node whose children are viewed.
+    //! \param name Name of viewed children, or 0 to view all children; this string doesn't have to be zero-terminated if name_size is non-zero.
+    //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+    //! \return View of children.
+    template<class Ch>
+    child_view<Ch> children(xml_node<Ch> *parent, const Ch *name = 0, std::size_t name_size = 0)
+    {
+        return child_view<Ch>(parent, name, name_size);
+    }
+
+    //! Creates view of attributes of a node, usable with range algorithms and adaptors.
+    //! \param node Node whose attributes are viewed.
+    //! \param name Name of viewed attributes, or 0 to view all attributes; this string doesn't have to be zero-terminated if name_size is non-zero.
+    //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+    //! \return View of attributes.
+    template<class Ch>
+    attribute_view<Ch> attributes(xml_node<Ch> *node, const Ch *name = 0, std::size_t name_size = 0)
+    {
+        return attribute_view<Ch>(node, name, name_size);
+    }
+
+    //! Creates view of descendants of a node in document order, usable with range algorithms and adaptors.
+    //! \param root Node whose descendants are viewed.
+    //! \param name Name of viewed descendants, or 0 to view descendants regardless of their name; this string doesn't have to be zero-terminated if name_size is non-zero.
+    //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+    //! \return View of descendants.
+    template<class Ch>
+    descendant_view<Ch> descendants(xml_node<Ch> *root, const Ch *name = 0, std::size_t name_size = 0)
+    {
+        return descendant_view<Ch>(root, name, name_size);
+    }
+
+    //! Creates view of descendants of a node of given type in document order, usable with range algorithms and adaptors.
+    //! \param root Node whose descendants are viewed.
+    //! \param type Type of viewed descendants.
+    //! \param name Name of viewed descendants, or 0 to view descendants regardless of their name; this string doesn't have to be zero-terminated if name_size is non-zero.
+    //! \param name_size Size of name, in characters, or 0 to have size calculated automatically from string.
+    //! \return View of descendants.
+    template<class Ch>
+    descendant_view<Ch> descendants(xml_node<Ch> *root, node_type type, const Ch *name = 0, std::size_t name_size = 0)
+    {
+        return descendant_view<Ch>(root, type, name, name_size);
+    }
+
+}
+
+//! \cond internal
+// Views only refer to nodes, so iterators obtained from them remain valid after the views are destroyed
+template<class Ch>
+inline constexpr bool std::ranges::enable_borrowed_range<rapidxml::child_view<Ch>> = true;
+template<class Ch>
+inline constexpr bool std::ranges::enable_borrowed_range<rapidxml::attribute_view<Ch>> = true;
+template<class Ch>
+inline constexpr bool std::ranges::enable_borrowed_range<rapidxml::descendant_view<Ch>> = true;
+//! \endcond
+
+#endif
+
+#endif
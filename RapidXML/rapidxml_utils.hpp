@@ -88,34 +88,54 @@ namespace rapidxml
 
     };
 
-    //! Counts children of node. Time complexity is O(n).
+    //! Counts children of node. Time complexity is O(1) if <code>RAPIDXML_NODE_COUNTS</code> is defined, otherwise O(n); see xml_node::child_count().
     //! \return Number of children of node
     template<class Ch>
     inline std::size_t count_children(xml_node<Ch> *node)
     {
-        xml_node<Ch> *child = node->first_node();
-        std::size_t count = 0;
-        while (child)
-        {
-            ++count;
-            child = child->next_sibling();
-        }
-        return count;
+        return node->child_count();
     }
 
-    //! Counts attributes of node. Time complexity is O(n).
+    //! Counts attributes of node. Time complexity is O(1) if <code>RAPIDXML_NODE_COUNTS</code> is defined, otherwise O(n); see xml_node::attribute_count().
     //! \return Number of attributes of node
     template<class Ch>
     inline std::size_t count_attributes(xml_node<Ch> *node)
     {
-        xml_attribute<Ch> *attr = node->first_attribute();
-        std::size_t count = 0;
-        while (attr)
+        return node->attribute_count();
+    }
+
+    //! Finds first child of node which is not ordered before a value, in children sorted by a comparison.
+    //! Children must be partitioned by <code>less(child, value)</code>, all children for which it is true coming first,
+    //! as is the case when they are sorted in ascending order of the compared key.
+    //! If children of node are indexed, see memory_pool::index_children(), binary search is used, taking O(log n) time;
+    //! otherwise children are walked from the first one.
+    //! \param node Node whose children are searched.
+    //! \param value Value to search for.
+    //! \param less Function object called as <code>less(const xml_node<Ch> &child, const T &value)</code>, returning true if child is ordered before value.
+    //! \return Pointer to first child not ordered before value, or 0 if there is none.
+    template<class Ch, class T, class Compare>
+    inline xml_node<Ch> *lower_bound_child(xml_node<Ch> *node, const T &value, Compare less)
+    {
+        if (!node->indexed_children())
+        {
+            xml_node<Ch> *child = node->first_node();
+            while (child && less(*child, value))
+                child = child->next_sibling();
+            return child;
+        }
+        std::size_t first = 0, count = node->child_count();
+        while (count > 0)
         {
-            ++count;
-            attr = attr->next_attribute();
+            std::size_t step = count / 2;
+            if (less(*node->nth_child(first + step), value))
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+                count = step;
         }
-        return count;
+        return node->nth_child(first);
     }
 
 }
@@ -0,0 +1,251 @@
+#ifndef RAPIDXML_VOCABULARY_HPP_INCLUDED
+#define RAPIDXML_VOCABULARY_HPP_INCLUDED
+
+// Copyright (C) 2006, 2009 Marcin Kalicinski
+// Copyright (C) 2019 https://github.com/Fe-Bell/RapidXML
+// Version 1.17
+// Revision $DateTime: 2023/09/19 23:27:00 $
+//! \file rapidxml_vocabulary.hpp This file contains xml_vocabulary, a set of element and attribute names
+//! known at compile time, which the parser classifies with a perfect hash
+
+#include "rapidxml.hpp"
+
+namespace rapidxml
+{
+
+    //! \cond internal
+    namespace internal
+    {
+
+        // Finalization mix of MurmurHash3, spreading bits of name hash over buckets and slots
+        constexpr std::uint32_t mix(std::uint32_t x)
+        {
+            x ^= x >> 16;
+            x *= 0x85ebca6bu;
+            x ^= x >> 13;
+            x *= 0xc2b2ae35u;
+            x ^= x >> 16;
+            return x;
+        }
+
+        // Smallest power of 2 not less than n
+        constexpr std::size_t power_of_two(std::size_t n)
+        {
+            std::size_t result = 1;
+            while (result < n)
+                result <<= 1;
+            return result;
+        }
+
+        // Reports invalid vocabulary; it is not constexpr, so reaching it while constructing a constexpr vocabulary is a compile error
+        inline void invalid_vocabulary(const char *what)
+        {
+            (void)what;
+            assert(0);
+        }
+
+    }
+    //! \endcond
+
+    //! Set of element and attribute names known at compile time, mapped to symbol IDs by a perfect hash built during compilation.
+    //! Symbol ID of a name is its 1-based position in the list the vocabulary was constructed from; unknown names map to 0.
+    //! Declare the vocabulary <code>constexpr</code>, together with an enumeration listing the same names in the same order,
+    //! and parse with xml_document::parse(Ch *, const xml_vocabulary<Ch, N> &),
+    //! so that the parser stores symbol ID of each name, see xml_base::symbol(), without any allocation;
+    //! this requires <code>RAPIDXML_NAME_SYMBOLS</code> to be defined:
+    //! <pre>
+    //! enum tag { tag_unknown, tag_Message, tag_Header, tag_id };
+    //! constexpr rapidxml::xml_vocabulary<char, 3> vocabulary({ "Message", "Header", "id" });
+    //! doc.parse<0>(text, vocabulary);
+    //! switch (node->symbol()) { case tag_Header: ... }
+    //! </pre>
+    //! Names are matched case-sensitively.
+    //! The lookup uses the name hash computed by the parser while scanning the name,
+    //! followed by two table reads and a single comparison of characters, so its cost does not depend on the number of names.
+    //! <br><br>
+    //! Names must be distinct; duplicates, or names whose 32-bit hashes are equal, make construction of a constexpr vocabulary fail to compile.
+    //! The vocabulary only refers to the names, so they should be string literals or other strings with static storage.
+    //! \param Ch Character type of names.
+    //! \param N Number of names.
+    template<class Ch, std::size_t N>
+    class xml_vocabulary
+    {
+
+        static_assert(N > 0, "Vocabulary must contain at least one name");
+
+    public:
+
+        //! Number of buckets of the first level of the perfect hash.
+        static constexpr std::size_t bucket_count = internal::power_of_two(N);
+
+        //! Number of slots of the second level of the perfect hash.
+        static constexpr std::size_t slot_count = internal::power_of_two(2 * N);
+
+        //! Constructs vocabulary from a list of names, building the perfect hash.
+        //! \param names Zero-terminated names; symbol ID of each name is its position in the list plus 1.
+        constexpr xml_vocabulary(const Ch *const (&names)[N])
+            : m_names()
+            , m_sizes()
+            , m_hashes()
+            , m_displacements()
+            , m_slots()
+        {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                m_names[i] = names[i];
+                m_sizes[i] = measure(names[i]);
+                m_hashes[i] = internal::hash(names[i], m_sizes[i]);
+                for (std::size_t j = 0; j < i; ++j)
+                    if (m_hashes[j] == m_hashes[i])
+                        internal::invalid_vocabulary(equal(j, names[i], m_sizes[i]) ? "duplicate name" : "names with equal hashes");
+            }
+            build();
+        }
+
+        //! Gets number of names in the vocabulary, which is also the largest symbol ID.
+        //! \return Number of names.
+        static constexpr std::size_t size()
+        {
+            return N;
+        }
+
+        //! Finds symbol ID of a name.
+        //! \param name Name to find; this string doesn't have to be zero-terminated if size is non-zero.
+        //! \param size Size of name, in characters, or 0 to have size calculated automatically from string.
+        //! \return Symbol ID of the name, or 0 if name is not in the vocabulary.
+        constexpr std::uint32_t find(const Ch *name, std::size_t size = 0) const
+        {
+            if (size == 0)
+                size = measure(name);
+            return find(name, size, internal::hash(name, size));
+        }
+
+        //! Finds symbol ID of a name whose hash is already known.
+        //! \param name Name to find; this string doesn't have to be zero-terminated.
+        //! \param size Size of name, in characters.
+        //! \param hash Hash of name, as returned by xml_base::name_hash().
+        //! \return Symbol ID of the name, or 0 if name is not in the vocabulary.
+        constexpr std::uint32_t find(const Ch *name, std::size_t size, std::uint32_t hash) const
+        {
+            std::uint32_t symbol = m_slots[slot(hash, m_displacements[bucket(hash)])];
+            if (symbol && m_hashes[symbol - 1] == hash && equal(symbol - 1, name, size))
+                return symbol;
+            return 0;
+        }
+
+        //! Gets name of a symbol.
+        //! \param symbol Symbol ID, from 1 to size().
+        //! \return Zero-terminated name of the symbol.
+        constexpr const Ch *name(std::uint32_t symbol) const
+        {
+            assert(symbol > 0 && symbol <= N);
+            return m_names[symbol - 1];
+        }
+
+        //! Gets size of name of a symbol.
+        //! \param symbol Symbol ID, from 1 to size().
+        //! \return Size of name, in characters, not including terminator.
+        constexpr std::size_t name_size(std::uint32_t symbol) const
+        {
+            assert(symbol > 0 && symbol <= N);
+            return m_sizes[symbol - 1];
+        }
+
+    private:
+
+        // Largest displacement tried for a bucket before giving up
+        static constexpr std::uint32_t max_displacement = 1u << 20;
+
+        static constexpr std::size_t measure(const Ch *p)
+        {
+            std::size_t size = 0;
+            while (p[size])
+                ++size;
+            return size;
+        }
+
+        static constexpr std::size_t bucket(std::uint32_t hash)
+        {
+            return internal::mix(hash) & (bucket_count - 1);
+        }
+
+        static constexpr std::size_t slot(std::uint32_t hash, std::uint32_t displacement)
+        {
+            return internal::mix(hash + displacement * 0x9e3779b9u) & (slot_count - 1);
+        }
+
+        constexpr bool equal(std::size_t index, const Ch *name, std::size_t size) const
+        {
+            if (m_sizes[index] != size)
+                return false;
+            for (std::size_t i = 0; i < size; ++i)
+                if (m_names[index][i] != name[i])
+                    return false;
+            return true;
+        }
+
+        // Hash and displace: place buckets largest first, each with the first displacement that moves all its names to free slots
+        constexpr void build()
+        {
+            // Sort names by bucket
+            std::size_t counts[bucket_count] = {};
+            std::size_t starts[bucket_count + 1] = {};
+            std::size_t order[N] = {};
+            std::size_t largest = 0;
+            for (std::size_t i = 0; i < N; ++i)
+                ++counts[bucket(m_hashes[i])];
+            for (std::size_t b = 0; b < bucket_count; ++b)
+            {
+                starts[b + 1] = starts[b] + counts[b];
+                if (counts[b] > largest)
+                    largest = counts[b];
+            }
+            std::size_t filled[bucket_count] = {};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                std::size_t b = bucket(m_hashes[i]);
+                order[starts[b] + filled[b]++] = i;
+            }
+
+            // Place buckets
+            for (std::size_t count = largest; count > 0; --count)
+                for (std::size_t b = 0; b < bucket_count; ++b)
+                    if (counts[b] == count)
+                        place(b, order + starts[b], count);
+        }
+
+        constexpr void place(std::size_t b, const std::size_t *members, std::size_t count)
+        {
+            for (std::uint32_t displacement = 0; displacement < max_displacement; ++displacement)
+            {
+                std::size_t placed = 0;
+                while (placed < count && !m_slots[slot(m_hashes[members[placed]], displacement)])
+                {
+                    m_slots[slot(m_hashes[members[placed]], displacement)] = static_cast<std::uint32_t>(members[placed] + 1);
+                    ++placed;
+                }
+                if (placed == count)
+                {
+                    m_displacements[b] = displacement;
+                    return;
+                }
+                while (placed > 0)
+                {
+                    --placed;
+                    m_slots[slot(m_hashes[members[placed]], displacement)] = 0;
+                }
+            }
+            internal::invalid_vocabulary("no perfect hash found");
+        }
+
+        const Ch *m_names[N];                           // Names, in order of symbol IDs
+        std::size_t m_sizes[N];                         // Sizes of names
+        std::uint32_t m_hashes[N];                      // Hashes of names
+        std::uint32_t m_displacements[bucket_count];    // Displacement of each bucket
+        std::uint32_t m_slots[slot_count];              // Symbol ID in each slot, or 0 if slot is empty
+
+    };
+
+}
+
+#endif